@@ -0,0 +1,214 @@
+/**
+* @file benchmark.cpp
+* @author Kamil Rog
+*
+*
+*/
+
+
+#include "benchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+
+
+/**
+* Opens the hardware counters, the results include them from
+* then on. Benchmarks keep reporting the wall clock time if the
+* counters are not available.
+*
+* @return 0 on success, -1 if the counters are not available
+*
+*/
+int BenchmarkRunner::EnableCounters()
+{
+    m_countersRequested = true;
+    if(m_counters.Open() != 0)
+    {
+        std::cerr << "Hardware counters not available, " << m_counters.GetError() 
+        << ", reporting wall clock time only" << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+
+/**
+* @param name name of the benchmark
+*
+* @return true if the benchmark passes the filter
+*
+*/
+bool BenchmarkRunner::IsEnabled(const std::string &name) const
+{
+    return m_filter.empty() || (name.find(m_filter) != std::string::npos);
+}
+
+
+/**
+* Runs one benchmark and records its statistics. Iterations
+* return 0 on success, failures are counted but still timed.
+*
+* @param name name of the benchmark, i.e. the stage
+*
+* @param params parameters of the benchmark
+*
+* @param nSamples number of samples processed by one iteration
+*
+* @param iteration function executing one iteration
+*
+* @return 0 on success, -1 if filtered out or there are no repeats
+*
+*/
+int BenchmarkRunner::Run(const std::string &name, const BenchmarkParams &params, size_t nSamples, const std::function<int()> &iteration)
+{
+    if(!IsEnabled(name) || (m_nRepeats == 0))
+    {
+        return -1;
+    }
+    for(size_t i = 0; i < m_nWarmup; i++)
+    {
+        iteration();
+    }
+
+    std::vector<double> times(m_nRepeats);
+    size_t nErrors = 0;
+    for(size_t i = 0; i < m_nRepeats; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        int status = iteration();
+        auto end = std::chrono::steady_clock::now();
+        times[i] = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        nErrors += (status != 0);
+    }
+
+    BenchmarkResult result;
+    result.name = name;
+    result.params = params;
+    result.nSamples = nSamples;
+    result.nRepeats = m_nRepeats;
+    result.nErrors = nErrors;
+    double sum = 0.0;
+    for(double time : times)
+    {
+        sum += time;
+    }
+    result.mean = sum / (double) m_nRepeats;
+    std::sort(times.begin(), times.end());
+    result.min = times.front();
+    result.median = (m_nRepeats % 2) ? times[m_nRepeats/2] : 0.5 * (times[m_nRepeats/2 - 1] + times[m_nRepeats/2]);
+    // Nearest rank percentile
+    size_t p99Rank = (size_t) std::ceil(0.99 * (double) m_nRepeats);
+    result.p99 = times[std::max(p99Rank, (size_t) 1) - 1];
+    result.samplesPerSecond = (result.median > 0.0) ? (double) nSamples * 1e9 / result.median : 0.0;
+
+    // Untimed pass counting the hardware events
+    PerfReading reading;
+    result.hasCounters = (m_counters.Start() == 0);
+    if(result.hasCounters)
+    {
+        for(size_t i = 0; i < m_nRepeats; i++)
+        {
+            iteration();
+        }
+        result.hasCounters = (m_counters.Stop(reading) == 0);
+    }
+    for(size_t event = 0; event < PERF_N_EVENTS; event++)
+    {
+        result.counters[event] = result.hasCounters ? (double) reading.values[event] / (double) m_nRepeats : 0.0;
+    }
+
+    m_results.push_back(result);
+    PrintResult(result, std::cout);
+    return 0;
+}
+
+
+/**
+* Prints one line of the results table
+*
+* @param result statistics of the benchmark
+*
+* @param stream destination stream
+*
+*/
+void BenchmarkRunner::PrintResult(const BenchmarkResult &result, std::ostream &stream) const
+{
+    stream << std::left << std::setw(28) << result.name << std::right
+    << " N=" << std::setw(5) << result.params.nPoints
+    << " CP=" << std::setw(5) << result.params.cyclicPrefixSize
+    << " step=" << std::setw(3) << result.params.pilotToneStep
+    << " QAM=" << std::setw(2) << result.params.QAMSize
+    << std::fixed << std::setprecision(0)
+    << "  median " << std::setw(10) << result.median << " ns"
+    << "  p99 " << std::setw(10) << result.p99 << " ns"
+    << std::scientific << std::setprecision(3)
+    << "  " << result.samplesPerSecond << " samples/s";
+    if(result.hasCounters)
+    {
+        double cycles = result.counters[PERF_CYCLES];
+        stream << std::fixed << std::setprecision(0)
+        << "  cycles " << cycles 
+        << std::setprecision(2) << "  IPC " << ((cycles > 0.0) ? result.counters[PERF_INSTRUCTIONS] / cycles : 0.0)
+        << std::setprecision(1) << "  cache misses " << result.counters[PERF_CACHE_MISSES]
+        << "  branch misses " << result.counters[PERF_BRANCH_MISSES];
+    }
+    if(result.nErrors)
+    {
+        stream << "  (" << result.nErrors << " errors)";
+    }
+    stream << std::defaultfloat << std::endl;
+}
+
+
+/**
+* Writes all results as a JSON document
+*
+* @param stream destination stream
+*
+* @return 0 on success, -1 if the stream failed
+*
+*/
+int BenchmarkRunner::WriteJson(std::ostream &stream) const
+{
+    stream << "{\n";
+    stream << "  \"warmup\": " << m_nWarmup << ",\n";
+    stream << "  \"repeats\": " << m_nRepeats << ",\n";
+    if(m_countersRequested)
+    {
+        stream << "  \"counters\": " << (m_counters.IsAvailable() ? "true" : "false") << ",\n";
+        if(!m_counters.IsAvailable())
+        {
+            stream << "  \"counters_error\": \"" << m_counters.GetError() << "\",\n";
+        }
+    }
+    stream << "  \"results\": [";
+    stream << std::setprecision(10);
+    for(size_t i = 0; i < m_results.size(); i++)
+    {
+        const BenchmarkResult &result = m_results[i];
+        stream << ((i == 0) ? "\n" : ",\n");
+        stream << "    {\"name\": \"" << result.name << "\""
+        << ", \"nPoints\": " << result.params.nPoints
+        << ", \"cyclicPrefixSize\": " << result.params.cyclicPrefixSize
+        << ", \"pilotToneStep\": " << result.params.pilotToneStep
+        << ", \"QAMSize\": " << result.params.QAMSize
+        << ", \"samples\": " << result.nSamples
+        << ", \"repeats\": " << result.nRepeats
+        << ", \"errors\": " << result.nErrors
+        << ", \"median_ns\": " << result.median
+        << ", \"p99_ns\": " << result.p99
+        << ", \"mean_ns\": " << result.mean
+        << ", \"min_ns\": " << result.min
+        << ", \"samples_per_second\": " << result.samplesPerSecond;
+        // Hardware events per iteration
+        for(size_t event = 0; (event < PERF_N_EVENTS) && result.hasCounters; event++)
+        {
+            stream << ", \"" << PerfCounters::GetEventName((PerfEvent) event) << "\": " << result.counters[event];
+        }
+        stream << "}";
+    }
+    stream << "\n  ]\n}\n";
+    return stream.good() ? 0 : -1;
+}
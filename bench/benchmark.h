@@ -0,0 +1,118 @@
+/**
+* @file benchmark.h
+* @author Kamil Rog
+*
+* @section DESCRIPTION
+*
+* Microbenchmark runner of the ofdmlib stages. Each benchmark
+* executes its iteration a number of warm-up times, then times
+* every repeat separately, so the median and the 99th percentile
+* of the iteration time can be reported along with the samples
+* processed per second. Results are printed as a table and can
+* be written as JSON to track regressions between builds.
+*
+* With the hardware counters enabled, the iterations are run
+* once more with the counters counting, untimed, and the counts
+* are reported per iteration, i.e. per symbol. Counting the whole
+* pass keeps the overhead of reading the counters out of the
+* timed repeats.
+*/
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <functional>
+#include <iostream>
+
+#include "perf-counters.h"
+
+
+/**
+ * @brief Parameters of a benchmark, 0 if the stage does not depend on it
+ *
+ */
+struct BenchmarkParams
+{
+    size_t nPoints = 0; // Number of FFT & IFFT coefficients
+    size_t cyclicPrefixSize = 0; // Cyclic-Prefix
+    size_t pilotToneStep = 0; // Pilot Tones
+    size_t QAMSize = 0; // QAM Modulator, bits per point
+};
+
+
+/**
+ * @brief Statistics of the timed repeats of one benchmark, times in ns
+ *
+ */
+struct BenchmarkResult
+{
+    std::string name;
+    BenchmarkParams params;
+    size_t nSamples; // Samples processed by one iteration
+    size_t nRepeats;
+    size_t nErrors; // Iterations which reported a failure
+    double median;
+    double p99;
+    double mean;
+    double min;
+    double samplesPerSecond; // Based on the median
+    bool hasCounters; // Hardware counters below are valid
+    double counters[PERF_N_EVENTS]; // Mean count of each event per iteration
+};
+
+
+/**
+ * @brief Runs, collects and reports the benchmarks
+ *
+ */
+class BenchmarkRunner {
+
+public:
+
+	/**
+	* Constructor
+	*
+	* @param nWarmup number of untimed iterations before the timed repeats
+	* @param nRepeats number of timed iterations
+	* @param filter only benchmarks whose name contains it are run, all if empty
+	*
+	*/
+	BenchmarkRunner(size_t nWarmup, size_t nRepeats, const std::string &filter) :
+	m_nWarmup(nWarmup),
+	m_nRepeats(nRepeats),
+	m_filter(filter)
+	{
+
+	}
+
+	int EnableCounters();
+	bool IsEnabled(const std::string &name) const;
+	int Run(const std::string &name, const BenchmarkParams &params, size_t nSamples, const std::function<int()> &iteration);
+	const std::vector<BenchmarkResult> &GetResults() const;
+	void PrintResult(const BenchmarkResult &result, std::ostream &stream) const;
+	int WriteJson(std::ostream &stream) const;
+
+private:
+
+	size_t m_nWarmup;
+	size_t m_nRepeats;
+	std::string m_filter;
+	std::vector<BenchmarkResult> m_results;
+	PerfCounters m_counters;
+	bool m_countersRequested = false;
+
+};
+
+
+/**
+* @return results of all benchmarks run so far
+*/
+inline const std::vector<BenchmarkResult> &BenchmarkRunner::GetResults() const
+{
+    return m_results;
+}
+
+#endif
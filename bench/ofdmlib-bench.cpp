@@ -0,0 +1,311 @@
+/**
+* @file ofdmlib-bench.cpp
+* @author Kamil Rog
+*
+* @section DESCRIPTION
+*
+* Microbenchmarks of the QAM modulator, the transforms, the
+* Nyquist modulator, the detector and the whole codec, swept over
+* the transform size, the cyclic prefix size and the pilot tone
+* step. Stages independent of a parameter are run once per value
+* of the parameters they depend on.
+*
+* Usage: ofdmlibBench [--repeats N] [--warmup N] [--filter name]
+*                     [--points 1024,8192] [--qam bits] [--json file]
+*                     [--counters]
+*
+* --counters adds the hardware counters of each stage, see
+* PerfCounters, if the system provides them.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <vector>
+#include <time.h>
+
+#include "benchmark.h"
+#include "ofdmcodec.h"
+#include "common.h"
+
+
+/**
+* Parses a comma separated list of sizes
+*
+* @param list text of the list
+*
+* @return sizes, empty if the list is malformed
+*
+*/
+static std::vector<size_t> ParseList(const std::string &list)
+{
+    std::vector<size_t> values;
+    std::stringstream stream(list);
+    std::string item;
+    while(std::getline(stream, item, ','))
+    {
+        char *end = nullptr;
+        unsigned long value = strtoul(item.c_str(), &end, 10);
+        if(item.empty() || (*end != '\0') || (value == 0))
+        {
+            return std::vector<size_t>();
+        }
+        values.push_back((size_t) value);
+    }
+    return values;
+}
+
+
+/**
+* Fills the buffer with random bytes
+*
+* @param data destination buffer
+*
+*/
+static void FillRandom(ByteVec &data)
+{
+    for(size_t i = 0; i < data.size(); i++)
+    {
+        data[i] = rand() % 256;
+    }
+}
+
+
+/**
+* @return settings of an encoder of the benchmarked parameters
+*/
+static OFDMSettings MakeSettings(const BenchmarkParams &params, int type)
+{
+    OFDMSettings settings;
+    settings.type = type;
+    settings.EnergyDispersalSeed = 10;
+    settings.nPoints = params.nPoints;
+    settings.pilotToneStep = params.pilotToneStep;
+    settings.pilotToneAmplitude = 2.0;
+    settings.guardInterval = 0;
+    settings.QAMSize = params.QAMSize;
+    settings.cyclicPrefixSize = params.cyclicPrefixSize;
+    return settings;
+}
+
+
+/**
+* QAM modulation and demodulation of one symbol
+*/
+static void BenchmarkQam(BenchmarkRunner &runner, const BenchmarkParams &params)
+{
+    QamModulator qam(params.nPoints, params.pilotToneStep, 2.0, 10, params.QAMSize);
+    size_t nBytes = qam.GetMaxEncodedBytes();
+    ByteVec data(nBytes);
+    FillRandom(data);
+    DoubleVec points(params.nPoints*2, 0.0);
+    ByteVec decoded(nBytes);
+
+    runner.Run("qam_modulate", params, params.nPoints, [&]() {
+        qam.Modulate(data.data(), points.data(), nBytes);
+        return 0;
+    });
+    qam.Modulate(data.data(), points.data(), nBytes);
+    runner.Run("qam_demodulate", params, params.nPoints, [&]() {
+        qam.Demodulate(points.data(), decoded.data(), nBytes);
+        return (decoded == data) ? 0 : -1;
+    });
+}
+
+
+/**
+* Forward and inverse complex transforms
+*/
+static void BenchmarkFFT(BenchmarkRunner &runner, const BenchmarkParams &params)
+{
+    ofdmFFT ifft(params.nPoints, FFTW_BACKWARD, params.pilotToneStep);
+    ofdmFFT fft(params.nPoints, FFTW_FORWARD, params.pilotToneStep);
+    for(size_t i = 0; i < params.nPoints; i++)
+    {
+        ifft.in[i][0] = (double) rand()/RAND_MAX;
+        ifft.in[i][1] = (double) rand()/RAND_MAX;
+    }
+    ifft.ComputeTransform();
+    std::copy((double *) ifft.out, (double *) (ifft.out + params.nPoints), (double *) fft.in);
+
+    runner.Run("fft_inverse", params, params.nPoints, [&]() {
+        return ifft.ComputeTransform();
+    });
+    runner.Run("fft_forward", params, params.nPoints, [&]() {
+        return fft.ComputeTransform();
+    });
+}
+
+
+/**
+* Nyquist modulation of the IFFT output and demodulation of the samples
+*/
+static void BenchmarkNyquist(BenchmarkRunner &runner, const BenchmarkParams &params)
+{
+    size_t symbolSize = params.nPoints*2;
+    fftw_complex *complexBuffer = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * params.nPoints);
+    DoubleVec samples(symbolSize);
+    for(size_t i = 0; i < symbolSize; i++)
+    {
+        samples[i] = (double) rand()/RAND_MAX;
+    }
+    std::copy(samples.begin(), samples.end(), (double *) complexBuffer);
+    NyquistModulator nyquist(params.nPoints, complexBuffer);
+
+    runner.Run("nyquist_modulate", params, symbolSize, [&]() {
+        nyquist.Modulate(complexBuffer, samples.data());
+        return 0;
+    });
+    runner.Run("nyquist_demodulate", params, symbolSize, [&]() {
+        nyquist.Demodulate(samples.data(), 0);
+        return 0;
+    });
+    fftw_free(complexBuffer);
+}
+
+
+/**
+* Symbol search of the detector and encoding and decoding of a
+* symbol by the codec. The received signal holds the symbol at
+* a random position within two symbols of silence.
+*/
+static void BenchmarkCodec(BenchmarkRunner &runner, const BenchmarkParams &params)
+{
+    OFDMCodec encoder(MakeSettings(params, FFTW_BACKWARD));
+    OFDMCodec decoder(MakeSettings(params, FFTW_FORWARD));
+    size_t nBytes = encoder.GetSymbolCapacity();
+    size_t symbolSize = encoder.GetSymbolSize();
+    ByteVec data(nBytes);
+    FillRandom(data);
+    DoubleVec symbol(symbolSize);
+    ByteVec decoded(nBytes);
+    // Received signal is built from the symbol even if the encode benchmark is filtered out
+    if(encoder.Encode(data.data(), nBytes, symbol.data(), symbol.size()) != 0)
+    {
+        fprintf(stderr, "Encoding of the benchmark symbol failed\n");
+        return;
+    }
+
+    runner.Run("codec_encode", params, symbolSize, [&]() {
+        return encoder.Encode(data.data(), nBytes, symbol.data(), symbol.size());
+    });
+
+    size_t prefixStart = symbolSize/2 + rand() % symbolSize;
+    DoubleVec rxSignal(symbolSize*3, 0.0);
+    std::copy(symbol.begin(), symbol.end(), rxSignal.begin() + prefixStart);
+
+    ofdmFFT fft(params.nPoints, FFTW_FORWARD, params.pilotToneStep);
+    fft.SetBitsPerSymbol(params.QAMSize);
+    NyquistModulator nyquist(params.nPoints, fft.in);
+    Detector detector(params.nPoints, params.cyclicPrefixSize, &fft, &nyquist);
+    size_t expectedStart = prefixStart + params.cyclicPrefixSize;
+    // Each iteration searches the signal from its beginning
+    runner.Run("detector_find_symbol_start", params, rxSignal.size(), [&]() {
+        detector.SetSearchOffset(0);
+        size_t symbolStart = detector.FindSymbolStart(rxSignal.data(), rxSignal.size(), nBytes);
+        return (symbolStart == expectedStart) ? 0 : -1;
+    });
+
+    // Stages of the decoder at the symbol start
+    runner.Run("detector_correlator", params, params.cyclicPrefixSize, [&]() {
+        return (detector.ExecuteCorrelator(rxSignal.data(), prefixStart) >= detector.GetThreshold()) ? 0 : -1;
+    });
+    runner.Run("detector_fine_search", params, symbolSize, [&]() {
+        return (detector.FineSearch(rxSignal.data(), expectedStart, nBytes) == expectedStart) ? 0 : -1;
+    });
+
+    runner.Run("codec_decode", params, rxSignal.size(), [&]() {
+        decoder.ResetStream();
+        if(decoder.Decode(rxSignal.data(), rxSignal.size(), decoded.data(), nBytes) != 0)
+        {
+            return -1;
+        }
+        return (decoded == data) ? 0 : -1;
+    });
+}
+
+
+int main(int argc, char *argv[])
+{
+    size_t nRepeats = 200;
+    size_t nWarmup = 20;
+    size_t QAMSize = 2;
+    std::string filter;
+    std::string jsonFile;
+    std::vector<size_t> pointSizes = { 1024, 2048, 4096, 8192 };
+    std::vector<size_t> prefixDivisors = { 8, 4 }; // Cyclic prefix of 1/8 and 1/4 of the symbol
+    std::vector<size_t> pilotToneSteps = { 8, 16 };
+
+    bool useCounters = false;
+    for(int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        if(option == "--counters")
+        {
+            useCounters = true;
+            continue;
+        }
+        if(i + 1 >= argc)
+        {
+            fprintf(stderr, "Missing value of %s\n", option.c_str());
+            return 1;
+        }
+        std::string value = argv[++i];
+        if(option == "--repeats")      { nRepeats = strtoul(value.c_str(), nullptr, 10); }
+        else if(option == "--warmup")  { nWarmup = strtoul(value.c_str(), nullptr, 10); }
+        else if(option == "--qam")     { QAMSize = strtoul(value.c_str(), nullptr, 10); }
+        else if(option == "--filter")  { filter = value; }
+        else if(option == "--json")    { jsonFile = value; }
+        else if(option == "--points")  { pointSizes = ParseList(value); }
+        else
+        {
+            fprintf(stderr, "Unknown option %s\n", option.c_str());
+            return 1;
+        }
+    }
+    if(pointSizes.empty() || (QAMSize == 0) || (QAMSize > 8) || (QAMSize % 2))
+    {
+        fprintf(stderr, "Invalid --points or --qam value\n");
+        return 1;
+    }
+
+    srand( (unsigned)time( NULL ) );
+    BenchmarkRunner runner(nWarmup, nRepeats, filter);
+    if(useCounters)
+    {
+        runner.EnableCounters();
+    }
+    for(size_t nPoints : pointSizes)
+    {
+        BenchmarkParams params;
+        params.nPoints = nPoints;
+        BenchmarkFFT(runner, params);
+        BenchmarkNyquist(runner, params);
+        for(size_t pilotToneStep : pilotToneSteps)
+        {
+            params.pilotToneStep = pilotToneStep;
+            params.QAMSize = QAMSize;
+            params.cyclicPrefixSize = 0;
+            BenchmarkQam(runner, params);
+            for(size_t prefixDivisor : prefixDivisors)
+            {
+                params.cyclicPrefixSize = (nPoints*2) / prefixDivisor;
+                BenchmarkCodec(runner, params);
+            }
+        }
+    }
+
+    if(!jsonFile.empty())
+    {
+        std::ofstream stream(jsonFile);
+        if(runner.WriteJson(stream) != 0)
+        {
+            fprintf(stderr, "Failed to write %s\n", jsonFile.c_str());
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,155 @@
+/**
+* @file perf-counters.cpp
+* @author Kamil Rog
+*
+*
+*/
+
+
+#include "perf-counters.h"
+#include <cstring>
+#include <cerrno>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+
+/**
+* Opens the counters as one group led by the cycle counter.
+* The group is created disabled, see Start.
+*
+* @return 0 on success, -1 if the counters are not available
+*
+*/
+int PerfCounters::Open()
+{
+    Close();
+#ifdef __linux__
+    static const uint64_t configs[PERF_N_EVENTS] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+    for(size_t event = 0; event < PERF_N_EVENTS; event++)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[event];
+        attr.disabled = (event == 0);
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        int groupFd = (event == 0) ? -1 : m_fds[0];
+        int fd = (int) syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0);
+        if(fd < 0)
+        {
+            m_error = std::string("perf_event_open ") + GetEventName((PerfEvent) event) + ": " + strerror(errno);
+            Close();
+            return -1;
+        }
+        m_fds[event] = fd;
+    }
+    m_error.clear();
+    return 0;
+#else
+    m_error = "perf_event_open is only available on Linux";
+    return -1;
+#endif
+}
+
+
+/**
+* Closes all opened counters
+*
+*/
+void PerfCounters::Close()
+{
+#ifdef __linux__
+    // Members of the group first, the leader last
+    for(size_t event = PERF_N_EVENTS; event-- > 0;)
+    {
+        if(m_fds[event] >= 0)
+        {
+            close(m_fds[event]);
+        }
+        m_fds[event] = -1;
+    }
+#endif
+}
+
+
+/**
+* Resets the counters and starts counting
+*
+* @return 0 on success, -1 if not available
+*
+*/
+int PerfCounters::Start()
+{
+    if(!IsAvailable())
+    {
+        return -1;
+    }
+#ifdef __linux__
+    ioctl(m_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(m_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    return 0;
+}
+
+
+/**
+* Stops counting and reads the counts since Start
+*
+* @param reading destination of the counts
+*
+* @return 0 on success, -1 if not available or the read failed
+*
+*/
+int PerfCounters::Stop(PerfReading &reading)
+{
+    if(!IsAvailable())
+    {
+        return -1;
+    }
+#ifdef __linux__
+    ioctl(m_fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    // Number of events followed by their values
+    uint64_t buffer[1 + PERF_N_EVENTS];
+    if(read(m_fds[0], buffer, sizeof(buffer)) != (ssize_t) sizeof(buffer))
+    {
+        return -1;
+    }
+    for(size_t event = 0; event < PERF_N_EVENTS; event++)
+    {
+        reading.values[event] = buffer[1 + event];
+    }
+#endif
+    return 0;
+}
+
+
+/**
+* @param event counted hardware event
+*
+* @return name of the event used in the reports
+*
+*/
+const char *PerfCounters::GetEventName(PerfEvent event)
+{
+    switch(event)
+    {
+        case PERF_CYCLES:           return "cycles";
+        case PERF_INSTRUCTIONS:     return "instructions";
+        case PERF_CACHE_MISSES:     return "cache_misses";
+        case PERF_BRANCH_MISSES:    return "branch_misses";
+        default:                    return "unknown";
+    }
+}
@@ -0,0 +1,105 @@
+/**
+* @file perf-counters.h
+* @author Kamil Rog
+*
+* @section DESCRIPTION
+*
+* Hardware performance counters of the calling thread, read
+* through the Linux perf_event_open interface. Cycles, retired
+* instructions, last level cache misses and branch misses are
+* counted as one group, so all of them cover the same code.
+* Only user space is counted, which perf_event_paranoid levels
+* up to 2 allow. Where the counters can not be opened, i.e. other
+* operating systems, containers or virtual machines without a
+* PMU, IsAvailable() is false and the benchmarks report only
+* the wall clock time.
+*/
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+
+
+/**
+ * @brief Counted hardware events
+ *
+ */
+enum PerfEvent {
+	PERF_CYCLES,
+	PERF_INSTRUCTIONS,
+	PERF_CACHE_MISSES,
+	PERF_BRANCH_MISSES,
+	PERF_N_EVENTS
+};
+
+
+/**
+ * @brief Counts of the events, over one or more iterations
+ *
+ */
+struct PerfReading
+{
+    uint64_t values[PERF_N_EVENTS] = {};
+};
+
+
+/**
+ * @brief Group of hardware counters of the calling thread
+ *
+ */
+class PerfCounters {
+
+public:
+
+	PerfCounters()
+	{
+
+	}
+
+	/**
+	* Destructor closes the counters
+	*/
+	~PerfCounters()
+	{
+		Close();
+	}
+
+	PerfCounters(const PerfCounters &) = delete;
+	PerfCounters &operator=(const PerfCounters &) = delete;
+
+	int Open();
+	void Close();
+	bool IsAvailable() const;
+	int Start();
+	int Stop(PerfReading &reading);
+	const std::string &GetError() const;
+	static const char *GetEventName(PerfEvent event);
+
+private:
+
+	int m_fds[PERF_N_EVENTS] = { -1, -1, -1, -1 };
+	std::string m_error; /// Reason the counters are not available
+
+};
+
+
+/**
+* @return true if all counters have been opened
+*/
+inline bool PerfCounters::IsAvailable() const
+{
+	return m_fds[0] >= 0;
+}
+
+
+/**
+* @return reason the counters could not be opened, empty if available
+*/
+inline const std::string &PerfCounters::GetError() const
+{
+	return m_error;
+}
+
+#endif
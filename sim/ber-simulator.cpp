@@ -0,0 +1,249 @@
+/**
+* @file ber-simulator.cpp
+* @author Kamil Rog
+*
+*
+*/
+
+
+#include "ber-simulator.h"
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <iomanip>
+#include <thread>
+
+
+/**
+* @return settings of a codec of the simulated parameters
+*/
+static OFDMSettings MakeSettings(const SimulationParams &params, int type)
+{
+    OFDMSettings settings;
+    settings.type = type;
+    settings.EnergyDispersalSeed = 10;
+    settings.nPoints = params.nPoints;
+    settings.pilotToneStep = params.pilotToneStep;
+    settings.pilotToneAmplitude = 2.0;
+    settings.guardInterval = 0;
+    settings.QAMSize = params.QAMSize;
+    settings.cyclicPrefixSize = params.cyclicPrefixSize;
+    settings.transform = params.transform;
+    settings.equaliser = params.equaliser;
+    return settings;
+}
+
+
+/**
+* Creates the codecs and buffers of one worker thread
+*
+* @param encoderSettings settings of the encoder
+*
+* @param decoderSettings settings of the decoder
+*
+* @param seed seed of the worker's random number generator
+*
+*/
+BerSimulator::Worker::Worker(const OFDMSettings &encoderSettings, const OFDMSettings &decoderSettings, uint64_t seed) :
+    encoder(encoderSettings),
+    decoder(decoderSettings),
+    generator(seed)
+{
+    size_t symbolSize = encoder.GetSymbolSize();
+    txIn.resize(encoder.GetSymbolCapacity());
+    rxOut.resize(encoder.GetSymbolCapacity());
+    symbol.resize(symbolSize);
+    // Symbol within two symbols of noise
+    rxSignal.resize(symbolSize*3);
+}
+
+
+/**
+* Creates the workers, codecs are constructed once and
+* reused by all points of the simulation.
+*
+* @param params codec parameters and stopping criteria
+*
+*/
+BerSimulator::BerSimulator(const SimulationParams &params) :
+    m_params(params)
+{
+    size_t nThreads = params.nThreads ? params.nThreads : std::thread::hardware_concurrency();
+    nThreads = std::max(nThreads, (size_t) 1);
+    OFDMSettings encoderSettings = MakeSettings(params, FFTW_BACKWARD);
+    OFDMSettings decoderSettings = MakeSettings(params, FFTW_FORWARD);
+    // Distinct, reproducible streams of random numbers per worker
+    std::seed_seq sequence{ params.seed };
+    std::vector<uint64_t> seeds(nThreads);
+    sequence.generate(seeds.begin(), seeds.end());
+    for(size_t i = 0; i < nThreads; i++)
+    {
+        m_workers.emplace_back(new Worker(encoderSettings, decoderSettings, seeds[i]));
+    }
+}
+
+
+/**
+* @return number of worker threads
+*/
+size_t BerSimulator::GetThreadCount() const
+{
+    return m_workers.size();
+}
+
+
+/**
+* @return number of bits carried by one symbol
+*/
+size_t BerSimulator::GetBitsPerSymbol() const
+{
+    return m_workers.front()->encoder.GetSymbolCapacity() * 8;
+}
+
+
+/**
+* Simulates one Eb/N0 point on all worker threads
+*
+* @param ebn0 energy per bit to noise power spectral density in dB
+*
+* @param point destination of the result
+*
+* @return 0 on success, -1 if a symbol carries no bits
+*
+*/
+int BerSimulator::Run(double ebn0, BerPoint &point)
+{
+    point = BerPoint();
+    point.ebn0 = ebn0;
+    if(GetBitsPerSymbol() == 0)
+    {
+        return -1;
+    }
+    PointCounters counters;
+    std::vector<std::thread> threads;
+    for(std::unique_ptr<Worker> &worker : m_workers)
+    {
+        threads.emplace_back(&BerSimulator::RunWorker, this, std::ref(*worker), ebn0, std::ref(counters));
+    }
+    for(std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    point.bits = counters.bits.load();
+    point.errors = counters.errors.load();
+    point.symbols = counters.symbols.load();
+    point.symbolErrors = counters.symbolErrors.load();
+    point.lostSymbols = counters.lostSymbols.load();
+    point.ber = point.bits ? (double) point.errors / (double) point.bits : 0.0;
+    return 0;
+}
+
+
+/**
+* Runs trials until the point has reached either stopping criterion
+*
+* @param worker codecs and buffers of the calling thread
+*
+* @param ebn0 energy per bit to noise power spectral density in dB
+*
+* @param counters counters of the point shared by the workers
+*
+*/
+void BerSimulator::RunWorker(Worker &worker, double ebn0, PointCounters &counters) const
+{
+    while( ( (counters.errors.load(std::memory_order_relaxed) < m_params.targetErrors) ||
+             (counters.symbolErrors.load(std::memory_order_relaxed) < m_params.targetSymbolErrors) ) &&
+           (counters.bits.load(std::memory_order_relaxed) < m_params.maxBits) )
+    {
+        RunTrial(worker, ebn0, counters);
+    }
+}
+
+
+/**
+* Encodes a symbol of random bytes, adds noise of the power
+* given by Eb/N0 and the energy of the symbol, prefix and pilot
+* tones included, and decodes it. Symbols which are not
+* found count as decoded to zeros.
+*
+* @param worker codecs and buffers of the calling thread
+*
+* @param ebn0 energy per bit to noise power spectral density in dB
+*
+* @param counters counters of the point shared by the workers
+*
+*/
+void BerSimulator::RunTrial(Worker &worker, double ebn0, PointCounters &counters) const
+{
+    size_t nBytes = worker.txIn.size();
+    size_t symbolSize = worker.symbol.size();
+    std::uniform_int_distribution<int> byteDistribution(0, 255);
+    for(uint8_t &byte : worker.txIn)
+    {
+        byte = (uint8_t) byteDistribution(worker.generator);
+    }
+    worker.encoder.Encode(worker.txIn.data(), nBytes, worker.symbol.data(), symbolSize);
+
+    // Real samples carry N0/2 of noise power each
+    double energy = 0.0;
+    for(double sample : worker.symbol)
+    {
+        energy += sample * sample;
+    }
+    double energyPerBit = energy / (double) (nBytes * 8);
+    double sigma = std::sqrt(energyPerBit / (2.0 * std::pow(10.0, ebn0 / 10.0)));
+    std::normal_distribution<double> noise(0.0, sigma);
+
+    std::uniform_int_distribution<size_t> startDistribution(symbolSize/2, symbolSize/2 + symbolSize - 1);
+    size_t prefixStart = startDistribution(worker.generator);
+    std::fill(worker.rxSignal.begin(), worker.rxSignal.end(), 0.0);
+    std::copy(worker.symbol.begin(), worker.symbol.end(), worker.rxSignal.begin() + prefixStart);
+    for(double &sample : worker.rxSignal)
+    {
+        sample += noise(worker.generator);
+    }
+
+    // Each trial searches its buffer from the beginning
+    worker.decoder.ResetStream();
+    std::fill(worker.rxOut.begin(), worker.rxOut.end(), 0);
+    int status = worker.decoder.Decode(worker.rxSignal.data(), worker.rxSignal.size(), worker.rxOut.data(), nBytes);
+
+    uint64_t errors = 0;
+    for(size_t i = 0; i < nBytes; i++)
+    {
+        errors += std::bitset<8>(worker.txIn[i] ^ worker.rxOut[i]).count();
+    }
+    counters.bits.fetch_add(nBytes * 8, std::memory_order_relaxed);
+    counters.errors.fetch_add(errors, std::memory_order_relaxed);
+    counters.symbols.fetch_add(1, std::memory_order_relaxed);
+    counters.symbolErrors.fetch_add(errors ? 1 : 0, std::memory_order_relaxed);
+    counters.lostSymbols.fetch_add((status != 0) ? 1 : 0, std::memory_order_relaxed);
+}
+
+
+/**
+* Writes the curve as comma separated values with a header row
+*
+* @param points results of the simulated points
+*
+* @param stream destination stream
+*
+* @return 0 on success, -1 if the stream failed
+*
+*/
+int BerSimulator::WriteCsv(const std::vector<BerPoint> &points, std::ostream &stream)
+{
+    stream << "ebn0_db,bits,errors,ber,symbols,symbol_errors,lost_symbols\n";
+    for(const BerPoint &point : points)
+    {
+        stream << std::setprecision(6) << point.ebn0
+        << "," << point.bits
+        << "," << point.errors
+        << "," << std::scientific << std::setprecision(6) << point.ber << std::defaultfloat
+        << "," << point.symbols
+        << "," << point.symbolErrors
+        << "," << point.lostSymbols << "\n";
+    }
+    stream.flush();
+    return stream.good() ? 0 : -1;
+}
@@ -0,0 +1,122 @@
+/**
+* @file ber-simulator.h
+* @author Kamil Rog
+*
+* @section DESCRIPTION
+*
+* Monte-Carlo simulation of the bit error rate of the codec in
+* additive white Gaussian noise. Each trial encodes one symbol of
+* random bytes, places it at a random position in a noisy Rx
+* buffer, so the detector has to find it, and decodes it.
+*
+* Trials are independent and spread across worker threads, each
+* with its own encoder, decoder and random number generator.
+* A point stops once both the target number of bit errors and of
+* symbols with errors, or the maximum number of bits, have been
+* reached. A symbol with a timing error loses most of its bits,
+* counting bits alone would stop after a single such burst.
+* Workers finish the trial in progress, so the counts can exceed
+* the targets by up to one symbol per thread.
+*/
+#ifndef BER_SIMULATOR_H
+#define BER_SIMULATOR_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <vector>
+#include <ostream>
+
+#include "ofdmcodec.h"
+#include "common.h"
+
+
+/**
+ * @brief Codec parameters and stopping criteria of a simulation
+ *
+ */
+struct SimulationParams
+{
+    size_t nPoints = 1024;
+    size_t pilotToneStep = 8;
+    size_t QAMSize = 2;
+    size_t cyclicPrefixSize = 256;
+    TransformType transform = TRANSFORM_COMPLEX;
+    EqualiserType equaliser = EQUALISER_NONE; // Equaliser of the decoder
+    uint64_t targetErrors = 100; // Bit errors after which a point stops
+    uint64_t targetSymbolErrors = 10; // Symbols with errors also required to stop, errors come in bursts of a symbol
+    uint64_t maxBits = 100000000; // Bits after which a point stops regardless of the errors
+    size_t nThreads = 0; // Worker threads, 0 uses all cores
+    uint64_t seed = 1; // Seed of the random number generators of the workers
+};
+
+
+/**
+ * @brief Result of one Eb/N0 point
+ *
+ */
+struct BerPoint
+{
+    double ebn0 = 0.0; // Energy per bit to noise power spectral density in dB
+    uint64_t bits = 0; // Transmitted bits
+    uint64_t errors = 0; // Bit errors
+    uint64_t symbols = 0; // Transmitted symbols
+    uint64_t symbolErrors = 0; // Symbols with at least one bit error
+    uint64_t lostSymbols = 0; // Symbols the detector did not find
+    double ber = 0.0; // errors / bits
+};
+
+
+/**
+ * @brief Multithreaded bit error rate simulator
+ *
+ */
+class BerSimulator {
+
+public:
+
+	explicit BerSimulator(const SimulationParams &params);
+
+	int Run(double ebn0, BerPoint &point);
+	size_t GetThreadCount() const;
+	size_t GetBitsPerSymbol() const;
+	static int WriteCsv(const std::vector<BerPoint> &points, std::ostream &stream);
+
+private:
+
+	/**
+	 * @brief Codecs, generator and buffers owned by one thread
+	 */
+	struct Worker {
+		Worker(const OFDMSettings &encoderSettings, const OFDMSettings &decoderSettings, uint64_t seed);
+		OFDMCodec encoder;
+		OFDMCodec decoder;
+		std::mt19937_64 generator;
+		ByteVec txIn;
+		ByteVec rxOut;
+		DoubleVec symbol;
+		DoubleVec rxSignal;
+	};
+
+	/**
+	 * @brief Counters of the point in progress shared by the workers
+	 */
+	struct PointCounters {
+		std::atomic<uint64_t> bits{0};
+		std::atomic<uint64_t> errors{0};
+		std::atomic<uint64_t> symbols{0};
+		std::atomic<uint64_t> symbolErrors{0};
+		std::atomic<uint64_t> lostSymbols{0};
+	};
+
+	void RunWorker(Worker &worker, double ebn0, PointCounters &counters) const;
+	void RunTrial(Worker &worker, double ebn0, PointCounters &counters) const;
+
+	SimulationParams m_params;
+	std::vector<std::unique_ptr<Worker>> m_workers;
+
+};
+
+#endif
@@ -0,0 +1,231 @@
+/**
+* @file ofdmlib-sim.cpp
+* @author Kamil Rog
+*
+* @section DESCRIPTION
+*
+* Bit error rate versus Eb/N0 curve of the codec in additive white
+* Gaussian noise, see BerSimulator. The sweep ends after the first
+* point without errors, points of higher Eb/N0 would not produce
+* any within the same number of bits either.
+*
+* Usage: ofdmlibSim [--points N] [--step N] [--qam bits] [--prefix N]
+*                   [--real] [--equaliser none|zf]
+*                   [--ebn0 start:stop:step] [--errors N] [--symbol-errors N]
+*                   [--max-bits N] [--threads N] [--seed N]
+*                   [--csv file] [--plot]
+*
+* The curve is written to stdout or the --csv file, --plot shows
+* it in gnuplot. A saved curve can be plotted with gnuplot-iostream:
+*
+*   Gnuplot gp;
+*   gp << "set datafile separator ','\n set logscale y\n";
+*   gp << "plot 'ber.csv' using 1:4 with linespoints\n";
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <utility>
+#include <chrono>
+
+#include "ber-simulator.h"
+#include "gnuplot-iostream.h"
+
+
+/**
+* Parses an Eb/N0 range in dB
+*
+* @param range text of the range, start:stop:step
+*
+* @param values destination of the Eb/N0 values
+*
+* @return 0 on success, -1 if the range is malformed
+*
+*/
+static int ParseRange(const std::string &range, std::vector<double> &values)
+{
+    double start = 0.0;
+    double stop = 0.0;
+    double step = 0.0;
+    char separator1 = 0;
+    char separator2 = 0;
+    std::stringstream stream(range);
+    if( !(stream >> start >> separator1 >> stop >> separator2 >> step) ||
+        (separator1 != ':') || (separator2 != ':') || !(step > 0.0) || (stop < start) )
+    {
+        return -1;
+    }
+    values.clear();
+    // Tolerate rounding of the last step
+    for(size_t i = 0; start + (double) i * step <= stop + step * 1e-9; i++)
+    {
+        values.push_back(start + (double) i * step);
+    }
+    return 0;
+}
+
+
+/**
+* Plots the points which have errors on a logarithmic scale
+*
+* @param points results of the simulated points
+*
+* @param title title of the curve
+*
+*/
+static void PlotCurve(const std::vector<BerPoint> &points, const std::string &title)
+{
+    std::vector<std::pair<double, double>> curve;
+    for(const BerPoint &point : points)
+    {
+        if(point.errors)
+        {
+            curve.push_back(std::make_pair(point.ebn0, point.ber));
+        }
+    }
+    if(curve.empty())
+    {
+        fprintf(stderr, "No errors to plot\n");
+        return;
+    }
+    Gnuplot gp;
+    gp << "set logscale y\n";
+    gp << "set grid\n";
+    gp << "set xlabel 'Eb/N0 [dB]'\n";
+    gp << "set ylabel 'BER'\n";
+    gp << "plot '-' with linespoints title '" << title << "'\n";
+    gp.send1d(curve);
+}
+
+
+int main(int argc, char *argv[])
+{
+    SimulationParams params;
+    params.cyclicPrefixSize = 0;
+    std::vector<double> ebn0Values;
+    ParseRange("0:12:1", ebn0Values);
+    std::string csvFile;
+    bool plot = false;
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        if(option == "--real")
+        {
+            params.transform = TRANSFORM_REAL;
+            continue;
+        }
+        if(option == "--plot")
+        {
+            plot = true;
+            continue;
+        }
+        if(i + 1 >= argc)
+        {
+            fprintf(stderr, "Missing value of %s\n", option.c_str());
+            return 1;
+        }
+        std::string value = argv[++i];
+        if(option == "--points")        { params.nPoints = strtoul(value.c_str(), nullptr, 10); }
+        else if(option == "--step")     { params.pilotToneStep = strtoul(value.c_str(), nullptr, 10); }
+        else if(option == "--qam")      { params.QAMSize = strtoul(value.c_str(), nullptr, 10); }
+        else if(option == "--prefix")   { params.cyclicPrefixSize = strtoul(value.c_str(), nullptr, 10); }
+        else if(option == "--errors")   { params.targetErrors = strtoull(value.c_str(), nullptr, 10); }
+        else if(option == "--symbol-errors") { params.targetSymbolErrors = strtoull(value.c_str(), nullptr, 10); }
+        else if(option == "--max-bits") { params.maxBits = strtoull(value.c_str(), nullptr, 10); }
+        else if(option == "--threads")  { params.nThreads = strtoul(value.c_str(), nullptr, 10); }
+        else if(option == "--seed")     { params.seed = strtoull(value.c_str(), nullptr, 10); }
+        else if(option == "--csv")      { csvFile = value; }
+        else if(option == "--equaliser")
+        {
+            if(value == "none")      { params.equaliser = EQUALISER_NONE; }
+            else if(value == "zf")   { params.equaliser = EQUALISER_ZF; }
+            else
+            {
+                fprintf(stderr, "Invalid --equaliser %s, expected none or zf\n", value.c_str());
+                return 1;
+            }
+        }
+        else if(option == "--ebn0")
+        {
+            if(ParseRange(value, ebn0Values) != 0)
+            {
+                fprintf(stderr, "Invalid --ebn0 range %s, expected start:stop:step\n", value.c_str());
+                return 1;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option %s\n", option.c_str());
+            return 1;
+        }
+    }
+    if( (params.nPoints == 0) || (params.pilotToneStep == 0) || !QamModulator::IsSupported(params.QAMSize) ||
+        (params.targetErrors == 0) || (params.maxBits == 0) )
+    {
+        fprintf(stderr, "Invalid --points, --step, --qam, --errors or --max-bits value\n");
+        return 1;
+    }
+    // Cyclic prefix of a quarter of the symbol by default
+    if(params.cyclicPrefixSize == 0)
+    {
+        size_t symbolSamples = (params.transform == TRANSFORM_REAL) ? params.nPoints : params.nPoints*2;
+        params.cyclicPrefixSize = symbolSamples / 4;
+    }
+
+    BerSimulator simulator(params);
+    if(simulator.GetBitsPerSymbol() == 0)
+    {
+        fprintf(stderr, "Symbols of these parameters carry no data\n");
+        return 1;
+    }
+    fprintf(stderr, "N=%zu CP=%zu step=%zu QAM=%zu, %zu bits per symbol, %zu threads\n",
+            params.nPoints, params.cyclicPrefixSize, params.pilotToneStep, params.QAMSize,
+            simulator.GetBitsPerSymbol(), simulator.GetThreadCount());
+
+    std::vector<BerPoint> points;
+    for(double ebn0 : ebn0Values)
+    {
+        BerPoint point;
+        auto start = std::chrono::steady_clock::now();
+        simulator.Run(ebn0, point);
+        auto end = std::chrono::steady_clock::now();
+        points.push_back(point);
+        fprintf(stderr, "Eb/N0 %6.2f dB  BER %.3e  %llu errors in %llu bits  %llu lost symbols  %.1f s\n",
+                point.ebn0, point.ber, (unsigned long long) point.errors, (unsigned long long) point.bits,
+                (unsigned long long) point.lostSymbols, std::chrono::duration<double>(end - start).count());
+        if(point.errors == 0)
+        {
+            fprintf(stderr, "No errors in %llu bits, skipping higher Eb/N0\n", (unsigned long long) point.bits);
+            break;
+        }
+    }
+
+    if(csvFile.empty())
+    {
+        BerSimulator::WriteCsv(points, std::cout);
+    }
+    else
+    {
+        std::ofstream stream(csvFile);
+        if(BerSimulator::WriteCsv(points, stream) != 0)
+        {
+            fprintf(stderr, "Failed to write %s\n", csvFile.c_str());
+            return 1;
+        }
+    }
+
+    if(plot)
+    {
+        std::stringstream title;
+        title << "N=" << params.nPoints << " CP=" << params.cyclicPrefixSize
+        << " step=" << params.pilotToneStep << " " << (1 << params.QAMSize) << "-QAM";
+        PlotCurve(points, title.str());
+    }
+    return 0;
+}
@@ -0,0 +1,179 @@
+/**
+* @file channel-estimator.cpp
+* @author Kamil Rog
+*
+*
+*/
+
+
+#include "channel-estimator.h"
+#include <algorithm>
+
+
+/**
+* Sets up the estimator for the transform size and pilot tones.
+*
+* @param nPoints Number of FFT coefficients
+*
+* @param pilotToneAmplitude transmitted amplitude of the pilot tones
+*
+* @param equaliser kind of the equaliser coefficients
+*
+* @return 0 on success, else error number
+*
+*/
+int ChannelEstimator::Configure(size_t nPoints, double pilotToneAmplitude, EqualiserType equaliser)
+{
+    if( (nPoints == 0) || (pilotToneAmplitude == 0.0) )
+    {
+        return -1;
+    }
+    m_nPoints = nPoints;
+    m_pilotToneAmplitude = pilotToneAmplitude;
+    m_equaliser = equaliser;
+    m_nDataPoints = (size_t) -1;
+    return 0;
+}
+
+
+/**
+* Estimates the channel of one symbol from its pilot tones and
+* computes the equaliser coefficients of its data points. Only
+* the pilot tones of the fft output are read.
+*
+* @param input pointer to the fft output, interleaved real and imag pairs
+*
+* @param layout data points and pilot tones of the symbol
+*
+* @param inputScale scale of the input points, folded into the pilot tone 
+* division and the coefficients
+*
+* @return 0 on success, -1 if the symbol has no pilot tones
+*
+*/
+int ChannelEstimator::Estimate(const double *input, const SubcarrierLayout &layout, double inputScale)
+{
+    const std::vector<size_t> &pilots = layout.GetPilotIndices();
+    if(pilots.empty())
+    {
+        return -1;
+    }
+    if(layout.GetDataIndices().size() != m_nDataPoints)
+    {
+        UpdateInterpolation(layout);
+    }
+
+    // Least squares estimate at the pilot tones
+    double pilotScale = inputScale / m_pilotToneAmplitude;
+    m_pilotChannel.resize(pilots.size()*2);
+    for(size_t pilot = 0; pilot < pilots.size(); pilot++)
+    {
+        m_pilotChannel[pilot*2] = input[pilots[pilot]*2] * pilotScale;
+        m_pilotChannel[pilot*2+1] = input[pilots[pilot]*2+1] * pilotScale;
+    }
+    m_noiseVariance = EstimateNoiseVariance();
+
+    for(size_t point = 0; point < m_nDataPoints; point++)
+    {
+        const double *left = &m_pilotChannel[m_leftPilot[point]*2];
+        const double *right = left + ((m_rightWeight[point] != 0.0) ? 2 : 0);
+        double weight = m_rightWeight[point];
+        double channelReal = left[0] + weight * (right[0] - left[0]);
+        double channelImag = left[1] + weight * (right[1] - left[1]);
+        m_channel[point*2] = channelReal;
+        m_channel[point*2+1] = channelImag;
+
+        double gain = channelReal * channelReal + channelImag * channelImag;
+        if(gain < CHANNEL_MIN_GAIN)
+        {
+            // Lost carrier carries no information
+            m_coefficients[point*2] = 0.0;
+            m_coefficients[point*2+1] = 0.0;
+            m_weights[point] = 0.0;
+            continue;
+        }
+        // Zero forcing coefficient conj(H) / |H|^2 is applied to the unscaled input
+        double coefficientScale = inputScale / gain;
+        m_coefficients[point*2] = channelReal * coefficientScale;
+        m_coefficients[point*2+1] = -channelImag * coefficientScale;
+        // Noise of the unbiased point is the noise variance over |H|^2
+        m_weights[point] = gain;
+    }
+    return 0;
+}
+
+
+/**
+* Finds the neighbouring pilot tones of each data point. Points
+* are ordered by their frequency, the centred layout wraps from
+* the negative frequencies to index 0, so indices below the first
+* data point follow the end of the transform.
+*
+* @param layout data points and pilot tones of the symbol
+*
+*/
+void ChannelEstimator::UpdateInterpolation(const SubcarrierLayout &layout)
+{
+    const std::vector<size_t> &data = layout.GetDataIndices();
+    const std::vector<size_t> &pilots = layout.GetPilotIndices();
+    m_nDataPoints = data.size();
+    m_leftPilot.resize(m_nDataPoints);
+    m_rightWeight.resize(m_nDataPoints);
+    m_channel.resize(m_nDataPoints*2);
+    m_coefficients.resize(m_nDataPoints*2);
+    m_weights.resize(m_nDataPoints);
+    if(m_nDataPoints == 0)
+    {
+        return;
+    }
+
+    size_t firstIndex = data[0];
+    auto frequency = [&](size_t index) { return (index < firstIndex) ? index + m_nPoints : index; };
+
+    size_t leftPilot = 0;
+    for(size_t point = 0; point < m_nDataPoints; point++)
+    {
+        size_t position = frequency(data[point]);
+        // Points beyond the outermost pilot tones extrapolate the outermost pair
+        while( (leftPilot + 2 < pilots.size()) && (frequency(pilots[leftPilot + 1]) < position) )
+        {
+            leftPilot++;
+        }
+        m_leftPilot[point] = leftPilot;
+        m_rightWeight[point] = 0.0;
+        if(leftPilot + 1 < pilots.size())
+        {
+            double leftPosition = (double) frequency(pilots[leftPilot]);
+            double rightPosition = (double) frequency(pilots[leftPilot + 1]);
+            m_rightWeight[point] = ((double) position - leftPosition) / (rightPosition - leftPosition);
+        }
+    }
+}
+
+
+/**
+* Estimates the noise power per point from the pilot tones. The
+* deviation of a pilot tone from the mean of its neighbours holds
+* 1.5 times the noise of one estimate, scaled by the pilot tone
+* power back to the noise of a received point.
+*
+* @return noise variance, 0 if there are fewer than 3 pilot tones
+*
+*/
+double ChannelEstimator::EstimateNoiseVariance() const
+{
+    size_t nPilots = m_pilotChannel.size() / 2;
+    if(nPilots < 3)
+    {
+        return 0.0;
+    }
+    double deviationSum = 0.0;
+    for(size_t pilot = 1; pilot + 1 < nPilots; pilot++)
+    {
+        double deviationReal = m_pilotChannel[pilot*2] - 0.5 * (m_pilotChannel[(pilot-1)*2] + m_pilotChannel[(pilot+1)*2]);
+        double deviationImag = m_pilotChannel[pilot*2+1] - 0.5 * (m_pilotChannel[(pilot-1)*2+1] + m_pilotChannel[(pilot+1)*2+1]);
+        deviationSum += deviationReal * deviationReal + deviationImag * deviationImag;
+    }
+    double deviationVariance = deviationSum / (double) (nPilots - 2);
+    return deviationVariance / 1.5 * m_pilotToneAmplitude * m_pilotToneAmplitude;
+}
@@ -0,0 +1,148 @@
+/**
+* @file channel-estimator.h
+* @author Kamil Rog
+*
+* @section DESCRIPTION
+*
+* Pilot tone channel estimator and one-tap equaliser coefficients.
+* The channel at each pilot tone is the received pilot divided by
+* the pilot tone amplitude, the channel at each data point is
+* linearly interpolated between its neighbouring pilot tones and
+* extrapolated from the outermost pair beyond them. Data points are
+* equalised by a complex multiplication with their coefficient,
+* which the demodulator applies while gathering the points.
+*
+* Zero forcing inverts the channel, the coefficient of each data
+* point is conj(H) / |H|^2 and the likelihood ratios of the point
+* are scaled by |H|^2, the noise of the equalised point being the
+* noise variance over |H|^2. The noise variance
+* is estimated from the deviation of each pilot tone from the
+* mean of its two neighbours. Scaled input, e.g. an unnormalised
+* FFT output, is calibrated by the pilot tone division and the
+* coefficients.
+*/
+#ifndef CHANNEL_ESTIMATOR_H
+#define CHANNEL_ESTIMATOR_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+
+#include "common.h"
+#include "subcarrier-layout.h"
+
+#define CHANNEL_MIN_GAIN 1e-12 // Squared channel magnitude below which a carrier is treated as lost
+
+
+/**
+ * @brief One-tap equaliser applied by the demodulator
+ *
+ */
+enum EqualiserType {
+	EQUALISER_NONE,
+	EQUALISER_ZF
+};
+
+
+/**
+ * @brief Pilot tone based channel estimator
+ *
+ */
+class ChannelEstimator {
+
+public:
+
+	/**
+	* Default constructor
+	*/
+	ChannelEstimator()
+	{
+
+	}
+
+	/**
+	* Constructor runs configure function.
+	*
+	* @param nPoints Number of FFT coefficients
+	* @param pilotToneAmplitude transmitted amplitude of the pilot tones
+	* @param equaliser kind of the equaliser coefficients
+	*
+	*/
+	ChannelEstimator(size_t nPoints, double pilotToneAmplitude, EqualiserType equaliser = EQUALISER_ZF)
+	{
+		Configure(nPoints, pilotToneAmplitude, equaliser);
+	}
+
+	int Configure(size_t nPoints, double pilotToneAmplitude, EqualiserType equaliser = EQUALISER_ZF);
+	int Estimate(const double *input, const SubcarrierLayout &layout, double inputScale = 1.0);
+	EqualiserType GetEqualiser() const;
+	const DoubleVec &GetChannel() const;
+	const DoubleVec &GetCoefficients() const;
+	const DoubleVec &GetWeights() const;
+	double GetNoiseVariance() const;
+
+private:
+
+	void UpdateInterpolation(const SubcarrierLayout &layout);
+	double EstimateNoiseVariance() const;
+
+	size_t m_nPoints = 0;
+	double m_pilotToneAmplitude = 1.0;
+	EqualiserType m_equaliser = EQUALISER_NONE;
+	size_t m_nDataPoints = (size_t) -1; /// Number of data points the interpolation is computed for
+	std::vector<size_t> m_leftPilot; /// Pilot tone preceding each data point
+	DoubleVec m_rightWeight; /// Interpolation weight of the pilot tone following each data point, outside [0, 1] when extrapolating
+	DoubleVec m_pilotChannel; /// Channel at each pilot tone, interleaved real and imag pairs
+	DoubleVec m_channel; /// Channel at each data point, interleaved real and imag pairs
+	DoubleVec m_coefficients; /// Equaliser coefficient of each data point, interleaved real and imag pairs
+	DoubleVec m_weights; /// Reliability of each equalised data point relative to the noise variance
+	double m_noiseVariance = 0.0;
+
+};
+
+
+/**
+* @return kind of the equaliser coefficients
+*/
+inline EqualiserType ChannelEstimator::GetEqualiser() const
+{
+	return m_equaliser;
+}
+
+
+/**
+* @return channel at each data point of the last estimate
+*/
+inline const DoubleVec &ChannelEstimator::GetChannel() const
+{
+	return m_channel;
+}
+
+
+/**
+* @return equaliser coefficient of each data point of the last estimate
+*/
+inline const DoubleVec &ChannelEstimator::GetCoefficients() const
+{
+	return m_coefficients;
+}
+
+
+/**
+* @return factor scaling the likelihood ratios of each equalised data point
+*/
+inline const DoubleVec &ChannelEstimator::GetWeights() const
+{
+	return m_weights;
+}
+
+
+/**
+* @return noise power per point before equalisation of the last estimate
+*/
+inline double ChannelEstimator::GetNoiseVariance() const
+{
+	return m_noiseVariance;
+}
+
+#endif
@@ -2,11 +2,13 @@
 * @file detector.cpp
 * @author Kamil Rog
 *
-* @todo: DEAL WITH WRAPAROUND FOR INCOMING BLOCKS OF DATA
+* Blocks of data arriving in chunks are handled by StreamSearch,
+* which keeps its state between calls.
 */
 
 #include "detector.h"
 #include <cstddef>
+#include <algorithm>
 
 
 /**
@@ -23,12 +25,14 @@ int Detector::Configure(size_t fftPoints, size_t prefixSize, ofdmFFT *fft, Nyqui
 {   
     // Set variables
     m_nPrefix = prefixSize;
-    m_symbolSize = fftPoints*2;
+    m_symbolSize = (fft->GetTransformType() == TRANSFORM_REAL) ? fftPoints : fftPoints*2;
     m_threshold = 0.8;
     m_configured = 1;
     m_SearchRange = 25;
     pFFT = fft;
 	pNyquistModulator = nyquist;
+    m_pilotDFT.Configure(fft, nyquist, m_SearchRange);
+    m_pilotBytes = 0;
     return 0;
 }
 
@@ -44,6 +48,22 @@ int Detector::Configure(size_t fftPoints, size_t prefixSize, ofdmFFT *fft, Nyqui
 *
 */
 double Detector::ExecuteCorrelator(const DoubleVec &input, size_t prefixOffset)
+{
+    return ExecuteCorrelator(input.data(), prefixOffset);
+}
+
+
+/**
+* Computes correlation in time domain on raw sample buffer.
+* 
+* @param input pointer to the Rx signal samples
+*
+* @param prefixOffset An index of the start of the prefix
+* 
+* @return correlation result
+*
+*/
+double Detector::ExecuteCorrelator(const double *input, size_t prefixOffset)
 {
     // Initialize output variable
     double correlation = 0;
@@ -62,6 +82,104 @@ double Detector::ExecuteCorrelator(const DoubleVec &input, size_t prefixOffset)
 }
 
 
+/**
+* Computes the energy of the difference between the expected
+* prefix and the end of the symbol. Unlike the correlation, which
+* forms a wide plateau over back to back symbols, this reaches
+* zero exactly at the prefix start of an undistorted symbol.
+* 
+* @param input pointer to the Rx signal samples
+*
+* @param prefixOffset An index of the start of the prefix
+* 
+* @return sum of squared differences
+*
+*/
+double Detector::ExecuteDifference(const double *input, size_t prefixOffset)
+{
+    double difference = 0;
+    // Set new prefix start to the symbol's end
+    size_t signalIndex = prefixOffset + m_symbolSize; 
+    for(size_t i = prefixOffset; i < m_nPrefix+prefixOffset; i++)
+    {
+        double delta = input[i] - input[signalIndex];
+        difference += delta * delta;
+        signalIndex++;
+    }
+    return difference;
+}
+
+
+/**
+* Computes correlation of the window at prefixOffset by updating
+* the correlation of the previous offset, adding the product entering
+* the window and subtracting the one leaving it. The sum is computed
+* exactly on a jump in offset and every symbol length of updates,
+* which bounds the accumulated rounding error. Callers invalidate 
+* the sum whenever the input buffer changes.
+* 
+* @param input pointer to the Rx signal samples
+*
+* @param prefixOffset An index of the start of the prefix
+* 
+* @return correlation result
+*
+*/
+double Detector::SlideCorrelator(const double *input, size_t prefixOffset)
+{
+    RunningSum &sum = m_correlationSum;
+    if(sum.valid && (prefixOffset == sum.offset + 1) && (sum.nSteps < m_symbolSize))
+    {
+        size_t leaving = sum.offset;
+        size_t entering = sum.offset + m_nPrefix;
+        sum.value += input[entering] * input[entering + m_symbolSize] - input[leaving] * input[leaving + m_symbolSize];
+        sum.nSteps++;
+    }
+    else
+    {
+        sum.value = ExecuteCorrelator(input, prefixOffset);
+        sum.nSteps = 0;
+        sum.valid = true;
+    }
+    sum.offset = prefixOffset;
+    return sum.value;
+}
+
+
+/**
+* Computes difference energy of the window at prefixOffset 
+* incrementally, in the same way as SlideCorrelator.
+* 
+* @param input pointer to the Rx signal samples
+*
+* @param prefixOffset An index of the start of the prefix
+* 
+* @return sum of squared differences
+*
+*/
+double Detector::SlideDifference(const double *input, size_t prefixOffset)
+{
+    RunningSum &sum = m_differenceSum;
+    if(sum.valid && (prefixOffset == sum.offset + 1) && (sum.nSteps < m_symbolSize))
+    {
+        size_t leaving = sum.offset;
+        size_t entering = sum.offset + m_nPrefix;
+        double deltaEntering = input[entering] - input[entering + m_symbolSize];
+        double deltaLeaving = input[leaving] - input[leaving + m_symbolSize];
+        sum.value += deltaEntering * deltaEntering - deltaLeaving * deltaLeaving;
+        sum.nSteps++;
+    }
+    else
+    {
+        sum.value = ExecuteDifference(input, prefixOffset);
+        sum.nSteps = 0;
+        sum.valid = true;
+    }
+    sum.offset = prefixOffset;
+    return sum.value;
+}
+
+
 /**
 * Computes the first symbol start in the provided input buffer
 * Firstly perform a coarse search (on prefix) and then fine search
@@ -73,19 +191,40 @@ double Detector::ExecuteCorrelator(const DoubleVec &input, size_t prefixOffset)
 *
 */
 size_t Detector::FindSymbolStart(const DoubleVec &input, size_t nBytes)
+{   
+    return FindSymbolStart(input.data(), input.size(), nBytes);
+}
+
+
+/**
+* Computes the first symbol start in the provided raw sample buffer
+* 
+* @param input pointer to the Rx signal samples
+*
+* @param inputSize number of samples in the buffer
+*
+* @param nBytes number of bytes encoded in the symbol
+* 
+* @return symbol start(integer) index, else -1
+*
+*/
+size_t Detector::FindSymbolStart(const double *input, size_t inputSize, size_t nBytes)
 {   
     size_t coarseStart = 0;
-    size_t symbolStart = 0;
+    size_t symbolStart = -1;
 
     // Coarse search
-    coarseStart = CoarseSearch(input);
-    coarseStart += m_nPrefix;
+    coarseStart = CoarseSearch(input, inputSize);
 
-    if(coarseStart >= 0)
+    if(coarseStart != (size_t) -1)
     {
-        // Pilot Tone Search
-        symbolStart = FineSearch(input, coarseStart, nBytes);
-        //symbolStart = CoarseStart;
+        // Skip the prefix 
+        coarseStart += m_nPrefix;
+        // Pilot Tone Search, if the whole search range is within the buffer
+        if(coarseStart + (m_SearchRange-1) / 2 + m_symbolSize <= inputSize)
+        {
+            symbolStart = FineSearch(input, coarseStart, nBytes);
+        }
     }
     // Return Symbol start
     return symbolStart;
@@ -104,41 +243,52 @@ size_t Detector::FindSymbolStart(const DoubleVec &input, size_t nBytes)
 */
 size_t Detector::FineSearch(const DoubleVec &buff, size_t coarseStart, size_t nbytes)
 {
-    double min = 100000;
-    double sumOfImag = 0.0;
-    int lowestImgIndex = 0;
+    return FineSearch(buff.data(), coarseStart, nbytes);
+}
+
 
-    size_t startIndex = 0;
+/**
+* Searches for the symbol start by assessing the 
+* value of the imaginary part of the pilot tones
+* locations on raw sample buffer. Only the pilot tone
+* bins are evaluated, see PilotDFT.
+* 
+* @param buff pointer to the Rx signal samples
+*
+* @param coarseStart start of the symbol found by coarse search
+*
+* @return fine symbol start index
+*
+*/
+size_t Detector::FineSearch(const double *buff, size_t coarseStart, size_t nbytes)
+{
+    PROFILE_SCOPE(m_profiler, PROFILE_FINE_SEARCH);
     // Restric start index of fine search to 0th element
-    if( startIndex >= 0)
-    {
-        startIndex = coarseStart - (int)((m_SearchRange-1) / 2);
-    }
-    else
-    {
-        startIndex = 0;
-    }
+    size_t halfRange = (m_SearchRange-1) / 2;
+    size_t startIndex = (coarseStart > halfRange) ? coarseStart - halfRange : 0;
 
     // TODO: Handle an exception where the stop index is outside the boundaries 
-    size_t stopIndex = coarseStart + (int)((m_SearchRange-1) / 2); 
+    size_t stopIndex = coarseStart + halfRange; 
 
-    for(size_t i = startIndex; i < stopIndex; i++)
+    UpdatePilots(nbytes);
+    return m_pilotDFT.Search(buff, startIndex, stopIndex);
+}
+
+
+/**
+* Pilot tone locations depend on the number of encoded bytes,
+* the pilot DFT is set up again only when the number changes.
+* 
+* @param nBytes number of bytes encoded in the symbol
+*
+*/
+void Detector::UpdatePilots(size_t nBytes)
+{
+    if(nBytes != m_pilotBytes)
     {
-        // Demodulate
-        pNyquistModulator->Demodulate(buff, i);
-        // Compute FFT
-        pFFT->ComputeTransform();
-        // Normalise
-        pFFT->Normalise();
-        // SUM imag parts
-        sumOfImag = abs(pFFT->GetImagSum(nbytes));
-        if( sumOfImag < min )
-        {
-            min = sumOfImag;
-            lowestImgIndex = i;
-        }
+        m_pilotDFT.SetPilots(pFFT->GetLayout(nBytes).GetPilotIndices());
+        m_pilotBytes = nBytes;
     }
-    return lowestImgIndex;
 }
 
 
@@ -151,6 +301,24 @@ size_t Detector::FineSearch(const DoubleVec &buff, size_t coarseStart, size_t nb
 */
 size_t Detector::CoarseSearch(const DoubleVec &input) // change return type to 
 {
+    return CoarseSearch(input.data(), input.size());
+}
+
+
+/**
+* Searches for the symbol start using correlator
+* on raw rx signal buffer to find expected prefix.
+* 
+* @param input pointer to the Rx signal samples
+*
+* @param inputSize number of samples in the buffer
+*
+* @return symbol start(integer) index, else -1
+*
+*/
+size_t Detector::CoarseSearch(const double *input, size_t inputSize)
+{
+    PROFILE_SCOPE(m_profiler, PROFILE_COARSE_SEARCH);
     bool startNotFound = true;
     double correlation = 0;
     bool thresholdExceeded = false;
@@ -158,11 +326,21 @@ size_t Detector::CoarseSearch(const DoubleVec &input) // change return type to
     double maxValue = 0.0;
     size_t maxValueIndex = 0;
 
+    // New buffer, the running correlation starts over
+    m_correlationSum.valid = false;
+
     // While the start of the symbol has not been found
     while(startNotFound) // Maybe set maximum itterations?
     {
+        // Stop once the correlator window does not fit in the buffer
+        if( m_startOffset + m_symbolSize + m_nPrefix > inputSize )
+        {
+            m_startOffset = 0;
+            // Whole buffer searched, no symbol has been detected
+            return -1;
+        }
         // Calculate correlation for a given offset
-        correlation = ExecuteCorrelator(input, m_startOffset);
+        correlation = SlideCorrelator(input, m_startOffset);
         // If the correlation exceeds the threshold
         if(correlation >= m_threshold)
         {
@@ -192,16 +370,102 @@ size_t Detector::CoarseSearch(const DoubleVec &input) // change return type to
         // The coarse search for this offset value has not been sucessfull,
         // Increment offset
         m_startOffset++;
+    }
+    return 0;
+}
 
-        // TODO: Need to add extra logic to tell the function when the whole buffer has been searched
-        if( m_startOffset == input.size() )
+
+/**
+* Searches for the prefix start in a stream of samples which
+* arrives in blocks. The search resumes from where the previous
+* call stopped, so each offset is correlated exactly once.
+* Once the correlation exceeds the threshold the prefix start is
+* located within the following two prefix lengths, which is the
+* width of the correlation peak, as the offset with the smallest
+* difference between the prefix and the end of the symbol.
+*
+* @param input pointer to the sample at absolute position inputStart
+*
+* @param inputStart absolute position of the first available sample
+*
+* @param inputEnd absolute position one past the last available sample
+*
+* @param prefixStart set to the absolute prefix start when found
+*
+* @return 0 when the prefix start has been found, 1 if more samples are required
+*
+*/
+int Detector::StreamSearch(const double *input, size_t inputStart, size_t inputEnd, size_t &prefixStart)
+{
+    PROFILE_SCOPE(m_profiler, PROFILE_COARSE_SEARCH);
+    // Never correlate samples which are no longer available
+    if(m_startOffset < inputStart)
+    {
+        m_startOffset = inputStart;
+    }
+    // The block may have moved, the running sums start over
+    m_correlationSum.valid = false;
+    m_differenceSum.valid = false;
+    // While the whole correlator window is available
+    while(m_startOffset + m_symbolSize + m_nPrefix <= inputEnd)
+    {
+        if(m_thresholdExceeded)
         {
-            m_startOffset = 0;
-            // Whole buffer searched, no symbol has been detected
-            return -1;
+            // Track the best match
+            double difference = SlideDifference(input, m_startOffset - inputStart);
+            if(difference < m_minDifference)
+            {
+                m_minDifference = difference;
+                m_peakIndex = m_startOffset;
+            }
+        }
+        // Threshold is exceeded for the first time
+        else if(SlideCorrelator(input, m_startOffset - inputStart) >= m_threshold)
+        {
+            m_thresholdExceeded = true;
+            m_minDifference = SlideDifference(input, m_startOffset - inputStart);
+            m_peakIndex = m_startOffset;
+            m_searchEnd = m_startOffset + 2*m_nPrefix;
+        }
+        m_startOffset++;
+        // Whole peak has been searched
+        if(m_thresholdExceeded && (m_startOffset >= m_searchEnd))
+        {
+            prefixStart = m_peakIndex;
+            m_thresholdExceeded = false;
+            return 0;
         }
     }
-    return 0;
+    return 1;
+}
+
+
+/**
+* Restarts the search at the specified position
+* and discards the state of the search in progress.
+*
+* @param offset absolute position of the first correlated sample
+*
+*/
+void Detector::SetSearchOffset(size_t offset)
+{
+    m_startOffset = offset;
+    m_thresholdExceeded = false;
+    m_minDifference = 0.0;
+    m_peakIndex = 0;
+}
+
+
+/**
+* Computes the oldest sample the search in progress may 
+* still need. Samples preceding it may be discarded.
+*
+* @return absolute position of the sample
+*
+*/
+size_t Detector::GetRetainOffset() const
+{
+    return m_thresholdExceeded ? m_peakIndex : m_startOffset;
 }
 
 
@@ -218,3 +482,106 @@ int Detector::Close()
     m_configured = 0;
     return 0;
 }
+
+
+/**
+* Locates the start of the next symbol of a continuous stream
+* once the timing has been acquired. The next symbol is expected 
+* one symbol and prefix length after the previous one, so only 
+* the prefix correlation at the predicted position, the prefix 
+* difference and the pilot tone search in a small window around 
+* it are computed. The lock is lost when the prefix no longer 
+* correlates or the smallest difference lies on the edge of the 
+* window, the caller then falls back to the full search.
+*
+* @param input pointer to the sample at absolute position inputStart
+*
+* @param inputStart absolute position of the first available sample
+*
+* @param inputEnd absolute position one past the last available sample
+*
+* @param nBytes number of bytes encoded in the symbol
+*
+* @param symbolStart set to the absolute symbol start when found
+*
+* @return 0 when the symbol start has been found, 1 if more samples 
+* are required, -1 if the lock has been lost
+*
+*/
+int Detector::TrackSymbolStart(const double *input, size_t inputStart, size_t inputEnd, size_t nBytes, size_t &symbolStart)
+{
+    PROFILE_SCOPE(m_profiler, PROFILE_TRACK);
+    if(!m_locked)
+    {
+        return -1;
+    }
+    size_t halfRange = (m_trackingRange-1) / 2;
+    // Samples of the predicted prefix are no longer available
+    if(m_predictedStart < inputStart + m_nPrefix + halfRange)
+    {
+        Unlock();
+        return -1;
+    }
+    size_t startIndex = m_predictedStart - halfRange;
+    size_t stopIndex = m_predictedStart + halfRange + 1;
+    // Wait until the whole window is available
+    if(stopIndex - 1 + m_symbolSize > inputEnd)
+    {
+        return 1;
+    }
+    // Prefix at the predicted position must still correlate
+    if(ExecuteCorrelator(input, m_predictedStart - m_nPrefix - inputStart) < m_threshold)
+    {
+        Unlock();
+        return -1;
+    }
+    // Difference between the prefix and the end of the symbol is the 
+    // lowest when aligned and grows with the misalignment
+    m_differenceSum.valid = false;
+    size_t bestOffset = startIndex;
+    double minDifference = 0.0;
+    for(size_t i = startIndex; i < stopIndex; i++)
+    {
+        double difference = SlideDifference(input, i - m_nPrefix - inputStart);
+        if(i == startIndex || difference < minDifference)
+        {
+            minDifference = difference;
+            bestOffset = i;
+        }
+    }
+    // Timing has moved further than the window covers
+    if(bestOffset == startIndex || bestOffset == stopIndex - 1)
+    {
+        Unlock();
+        return -1;
+    }
+    UpdatePilots(nBytes);
+    symbolStart = m_pilotDFT.Search(input, startIndex - inputStart, stopIndex - inputStart) + inputStart;
+    m_predictedStart = symbolStart + m_symbolPeriod;
+    return 0;
+}
+
+
+/**
+* Starts tracking the symbol timing after the symbol 
+* start has been found by the full search.
+*
+* @param symbolStart absolute start of the last symbol, after the prefix
+*
+*/
+void Detector::Lock(size_t symbolStart)
+{
+    m_locked = true;
+    m_predictedStart = symbolStart + m_symbolPeriod;
+    m_nAcquisitions++;
+}
+
+
+/**
+* Stops tracking, the next symbol requires the full search.
+*
+*/
+void Detector::Unlock()
+{
+    m_locked = false;
+}
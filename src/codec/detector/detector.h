@@ -19,6 +19,8 @@
 
 #include "ofdmfft.h"
 #include "nyquist-modulator.h"
+#include "pilot-dft.h"
+#include "stage-profiler.h"
 #include "common.h"
 
 #include <cstddef>
@@ -43,6 +45,23 @@ inline void AddCyclicPrefix(DoubleVec &symbol, uint32_t symbolSize, uint32_t pre
 }
 
 
+/**
+ * Creates cyclic prefix in place for a symbol which is
+ * part of a larger buffer i.e. a frame of symbols
+ * 
+ * @param symbol pointer to the start of the symbol, including prefix
+ * 
+ * @param symbolSize size of the symbol excluding prefix
+ * 
+ * @param prefixSize number of samples included in the prefix
+ * 
+ */
+inline void AddCyclicPrefix(double *symbol, size_t symbolSize, size_t prefixSize)
+{
+	std::copy(symbol+symbolSize, symbol+symbolSize+prefixSize, symbol);
+}
+
+
 /**
  * @brief Detector object repsonsible for calculating correlation
  * between signal and it's delayed version, where the expected prefix of 
@@ -67,10 +86,21 @@ public:
 			m_nPrefix(prefixSize),
 			m_threshold(30000.0), // TODO: Calibration function which listens to the noise and sets this value
 			m_startOffset(0),
-			m_symbolSize(nPoints*2),
+			m_symbolSize( (fft->GetTransformType() == TRANSFORM_REAL) ? nPoints : nPoints*2 ),
 			m_SearchRange(25),
+			m_thresholdExceeded(false),
+			m_minDifference(0.0),
+			m_peakIndex(0),
+			m_searchEnd(0),
+			m_locked(false),
+			m_predictedStart(0),
+			m_trackingRange(5),
+			m_symbolPeriod(m_symbolSize + prefixSize),
+			m_nAcquisitions(0),
 			pFFT(fft),
-			pNyquistModulator(nyquist)
+			pNyquistModulator(nyquist),
+			m_pilotDFT(fft, nyquist, m_SearchRange),
+			m_pilotBytes(0)
 	{
 		//Configure(nPoints, prefixSize, fft, nyquist);
 	}
@@ -88,23 +118,149 @@ public:
 	int Configure(size_t fftPoints, size_t prefixSize, ofdmFFT *fft, NyquistModulator *nyquist);
 	int Close();
 	size_t CoarseSearch(const DoubleVec &input);
+	size_t CoarseSearch(const double *input, size_t inputSize);
 		
 	double ExecuteCorrelator(const DoubleVec &input, size_t Offset);
+	double ExecuteCorrelator(const double *input, size_t Offset);
+	double ExecuteDifference(const double *input, size_t Offset);
 	size_t FindSymbolStart(const DoubleVec &input, size_t nbytes);
+	size_t FindSymbolStart(const double *input, size_t inputSize, size_t nbytes);
 	size_t FineSearch(const DoubleVec &input, size_t coarseStart, size_t nbytes);
+	size_t FineSearch(const double *input, size_t coarseStart, size_t nbytes);
+
+	// Streaming Search Related Functions //
+	int StreamSearch(const double *input, size_t inputStart, size_t inputEnd, size_t &prefixStart);
+	void SetSearchOffset(size_t offset);
+	size_t GetRetainOffset() const;
+	size_t GetSearchRange() const;
+	double GetThreshold() const;
+
+	// Tracking Related Functions //
+	int TrackSymbolStart(const double *input, size_t inputStart, size_t inputEnd, size_t nBytes, size_t &symbolStart);
+	void Lock(size_t symbolStart);
+	void Unlock();
+	bool IsLocked() const;
+	size_t GetPredictedStart() const;
+	void SetSymbolPeriod(size_t period);
+	size_t GetAcquisitionCount() const;
+
+	void SetProfiler(StageProfiler *profiler);
 
 private:
 
+	/**
+	 * @brief Running sum over the prefix window at offset
+	 */
+	struct RunningSum {
+		size_t offset;
+		size_t nSteps; /// Incremental updates since the last exact computation
+		double value;
+		bool valid;
+	};
+
+	double SlideCorrelator(const double *input, size_t prefixOffset);
+	double SlideDifference(const double *input, size_t prefixOffset);
+	void UpdatePilots(size_t nBytes);
+
 	int m_configured = 0;
 	size_t m_nPrefix;
 	double m_threshold; // TODO: Calibration function which listens to the noise and sets this value
 	size_t m_startOffset;
 	size_t m_symbolSize;
 	size_t m_SearchRange;
+	// Streaming search state
+	bool m_thresholdExceeded;
+	double m_minDifference;
+	size_t m_peakIndex;
+	size_t m_searchEnd;
+	RunningSum m_correlationSum = { 0, 0, 0.0, false };
+	RunningSum m_differenceSum = { 0, 0, 0.0, false };
+	// Tracking state
+	bool m_locked;
+	size_t m_predictedStart; /// Expected start of the next symbol, after the prefix
+	size_t m_trackingRange; /// Number of offsets around the predicted start searched when locked
+	size_t m_symbolPeriod; /// Samples from one symbol start to the next, prefix and guard interval included
+	size_t m_nAcquisitions; /// Number of times the timing has been locked by the full search
 	ofdmFFT *pFFT;
 	NyquistModulator* pNyquistModulator;
+	// Fine search state
+	PilotDFT m_pilotDFT;
+	size_t m_pilotBytes; /// Number of bytes the pilots have been set for
+	StageProfiler *m_profiler = nullptr; /// Records the search stages if set
 	//DoubleVec &input; 
 
 };
 
+
+/**
+* @return number of candidate offsets evaluated by the fine search
+*/
+inline size_t Detector::GetSearchRange() const
+{
+	return m_SearchRange;
+}
+
+
+/**
+* Sets the recorder of the coarse and fine search stages,
+* used only if the library is built with OFDMLIB_PROFILING
+*
+* @param profiler destination of the records, null to disable
+*/
+inline void Detector::SetProfiler(StageProfiler *profiler)
+{
+	m_profiler = profiler;
+}
+
+
+/**
+* @return correlation level which marks a prefix
+*/
+inline double Detector::GetThreshold() const
+{
+	return m_threshold;
+}
+
+
+
+/**
+* @return true if the symbol timing is being tracked
+*/
+inline bool Detector::IsLocked() const
+{
+	return m_locked;
+}
+
+
+/**
+* Sets the distance between consecutive symbols used to predict
+* the next symbol start when locked. Defaults to the prefix and
+* symbol, without a guard interval.
+*
+* @param period samples from one symbol start to the next
+*/
+inline void Detector::SetSymbolPeriod(size_t period)
+{
+	m_symbolPeriod = period;
+}
+
+
+/**
+* @return number of times the full search has locked the timing,
+* a lock kept by tracking is acquired once
+*/
+inline size_t Detector::GetAcquisitionCount() const
+{
+	return m_nAcquisitions;
+}
+
+
+/**
+* @return predicted start of the next symbol, valid when locked
+*/
+inline size_t Detector::GetPredictedStart() const
+{
+	return m_predictedStart;
+}
+
 #endif
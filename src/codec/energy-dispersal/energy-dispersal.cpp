@@ -0,0 +1,108 @@
+/**
+* @file energy-dispersal.cpp
+* @author Kamil Rog
+*
+* 
+*/
+
+
+#include "energy-dispersal.h"
+#include <cstring>
+
+
+/**
+* Generates the scrambling sequence. Register stage i is held
+* in bit i-1, every step the feedback of stages 14 and 15 is
+* both the output bit and the new first stage. Bits fill each
+* byte from the most significant one.
+* 
+* @param seed energy dispersal seed
+*
+* @param nBytes length of the sequence, the symbol capacity
+*
+* @return 0 on success, else error number
+*
+*/
+int EnergyDispersal::Configure(size_t seed, size_t nBytes)
+{
+    uint32_t shiftRegister = (PRBS_INIT_WORD ^ seed) & PRBS_REGISTER_MASK;
+    // All zero register never leaves zero state
+    if(shiftRegister == 0)
+    {
+        shiftRegister = PRBS_INIT_WORD;
+    }
+    m_sequence.resize(nBytes);
+    for(size_t i = 0; i < nBytes; i++)
+    {
+        uint8_t sequenceByte = 0;
+        for(size_t bit = 0; bit < BITS_IN_BYTE; bit++)
+        {
+            uint32_t feedback = ((shiftRegister >> 13) ^ (shiftRegister >> 14)) & 0x01;
+            shiftRegister = ((shiftRegister << 1) | feedback) & PRBS_REGISTER_MASK;
+            sequenceByte = (sequenceByte << 1) | feedback;
+        }
+        m_sequence[i] = sequenceByte;
+    }
+    return 0;
+}
+
+
+/**
+* Scrambles or descrambles the bytes of one symbol by xor-ing
+* them with the sequence, 8 bytes at a time. Input and output
+* may be the same buffer.
+* 
+* @param input pointer to the first of nBytes bytes
+*
+* @param output pointer to the destination of nBytes bytes
+*
+* @param nBytes number of bytes, at most the sequence length
+*
+*/
+void EnergyDispersal::Apply(const uint8_t *input, uint8_t *output, size_t nBytes) const
+{
+    const uint8_t *sequence = m_sequence.data();
+    size_t i = 0;
+    for(; i + sizeof(uint64_t) <= nBytes; i += sizeof(uint64_t))
+    {
+        uint64_t data;
+        uint64_t key;
+        memcpy(&data, &input[i], sizeof(uint64_t));
+        memcpy(&key, &sequence[i], sizeof(uint64_t));
+        data ^= key;
+        memcpy(&output[i], &data, sizeof(uint64_t));
+    }
+    for(; i < nBytes; i++)
+    {
+        output[i] = input[i] ^ sequence[i];
+    }
+}
+
+
+/**
+* Descrambles the likelihood ratios of the bits of one symbol.
+* Scrambling inverts a bit wherever the sequence bit is set,
+* so the sign of its ratio is flipped. Bit i of byte n is held
+* in ratios[n*8+i].
+* 
+* @param ratios pointer to the first of 8*nBytes likelihood ratios
+*
+* @param nBytes number of bytes, at most the sequence length
+*
+*/
+void EnergyDispersal::ApplySoft(float *ratios, size_t nBytes) const
+{
+    static const uint32_t bitMask[BITS_IN_BYTE] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80 };
+    for(size_t i = 0; i < nBytes; i++)
+    {
+        uint32_t key = m_sequence[i];
+        uint32_t words[BITS_IN_BYTE];
+        memcpy(words, &ratios[i*BITS_IN_BYTE], sizeof(words));
+        for(size_t bit = 0; bit < BITS_IN_BYTE; bit++)
+        {
+            // Sign bit is set where the sequence bit is
+            words[bit] ^= (key & bitMask[bit]) ? 0x80000000 : 0;
+        }
+        memcpy(&ratios[i*BITS_IN_BYTE], words, sizeof(words));
+    }
+}
@@ -0,0 +1,77 @@
+/**
+* @file energy-dispersal.h
+* @author Kamil Rog
+*
+* @section DESCRIPTION
+*
+* Energy dispersal scrambler. The scrambling sequence is the 
+* DVB pseudo random binary sequence, generated by the 
+* 1 + x^14 + x^15 linear feedback shift register, loaded with
+* the DVB initialisation word xor-ed with the seed. The sequence
+* of a symbol is computed once, scrambling xors 8 bytes at a time.
+* Each object holds its own sequence, so any number of codecs
+* can run on different threads.
+*/
+#ifndef ENERGY_DISPERSAL_H
+#define ENERGY_DISPERSAL_H
+
+#include <stdint.h>
+#include <cstddef>
+
+#include "common.h"
+
+#define PRBS_INIT_WORD 0x00A9 // 100101010000000 loaded from the first stage
+#define PRBS_REGISTER_MASK 0x7FFF
+
+
+/**
+ * @brief Precomputed energy dispersal sequence
+ * 
+ */
+class EnergyDispersal {
+
+public:
+
+	/**
+	* Constructor runs configure function.
+	* 
+	* @param seed energy dispersal seed
+	* @param nBytes length of the sequence, the symbol capacity
+	*
+	*/
+	EnergyDispersal(size_t seed, size_t nBytes)
+	{
+		Configure(seed, nBytes);
+	}
+
+	int Configure(size_t seed, size_t nBytes);
+	void Apply(const uint8_t *input, uint8_t *output, size_t nBytes) const;
+	void ApplySoft(float *ratios, size_t nBytes) const;
+	const uint8_t *GetSequence() const;
+	size_t GetSize() const;
+
+private:
+
+	ByteVec m_sequence;
+
+};
+
+
+/**
+* @return pointer to the scrambling sequence
+*/
+inline const uint8_t *EnergyDispersal::GetSequence() const
+{
+	return m_sequence.data();
+}
+
+
+/**
+* @return length of the scrambling sequence in bytes
+*/
+inline size_t EnergyDispersal::GetSize() const
+{
+	return m_sequence.size();
+}
+
+#endif
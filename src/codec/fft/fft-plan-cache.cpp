@@ -0,0 +1,302 @@
+/**
+* @file fft-plan-cache.cpp
+* @author Kamil Rog
+*
+* 
+*/
+
+
+#include "fft-plan-cache.h"
+#include <tuple>
+#include <cstdlib>
+#include <cstring>
+
+
+/**
+* Orders keys by all their properties
+* 
+* @param other key to compare with
+*
+* @return true if this key precedes the other
+*
+*/
+bool FFTPlanCache::PlanKey::operator<(const PlanKey &other) const
+{
+    return std::tie(nPoints, nTransforms, type, flags, inAlignment, outAlignment, inPlace, real) <
+           std::tie(other.nPoints, other.nTransforms, other.type, other.flags, other.inAlignment, other.outAlignment, other.inPlace, other.real);
+}
+
+
+/**
+* @return the registry of plans, created on first use
+*/
+std::map<FFTPlanCache::PlanKey, FFTPlanCache::PlanEntry> & FFTPlanCache::GetRegistry()
+{
+    static std::map<PlanKey, PlanEntry> registry;
+    return registry;
+}
+
+
+/**
+* The fftw planner is not thread safe. Every call which
+* creates or destroys plans or accesses the wisdom must hold this.
+* 
+* @return the mutex guarding the planner and the registry
+*
+*/
+std::mutex & FFTPlanCache::GetPlannerMutex()
+{
+    static std::mutex plannerMutex;
+    return plannerMutex;
+}
+
+
+/**
+* Returns a plan of nTransforms contiguous one dimensional
+* transforms nPoints apart. The plan is created on the first
+* request, plans which can not be created from wisdom alone are 
+* estimated. Planning with measurement overwrites the buffers.
+* Each call must be paired with a Release call.
+* 
+* @param nPoints size of each transform
+*
+* @param nTransforms number of transforms computed by the plan
+*
+* @param type FFTW_FORWARD or FFTW_BACKWARD
+*
+* @param flags fftw planner flags
+*
+* @param in pointer to the input buffer of the caller
+*
+* @param out pointer to the output buffer of the caller
+*
+* @return the plan, which may only be executed with fftw_execute_dft
+*
+*/
+fftw_plan FFTPlanCache::Acquire(int nPoints, int nTransforms, int type, unsigned flags, fftw_complex *in, fftw_complex *out)
+{
+    PlanKey key = { nPoints, nTransforms, type, flags,
+                    fftw_alignment_of((double *) in), fftw_alignment_of((double *) out), in == out, false };
+
+    std::lock_guard<std::mutex> lock(GetPlannerMutex());
+    fftw_plan plan = Find(key);
+    if(plan != NULL)
+    {
+        return plan;
+    }
+
+    int n[] = { nPoints };
+    char *wisdom = BeginPlanning(flags);
+    plan = fftw_plan_many_dft(1, n, nTransforms,
+                              in, NULL, 1, nPoints,
+                              out, NULL, 1, nPoints,
+                              type, flags);
+    if(plan == NULL)
+    {
+        // No wisdom for this transform
+        GetMisses()++;
+        plan = fftw_plan_many_dft(1, n, nTransforms,
+                                  in, NULL, 1, nPoints,
+                                  out, NULL, 1, nPoints,
+                                  type, FFTW_ESTIMATE);
+    }
+    EndPlanning(wisdom);
+    GetRegistry()[key] = { plan, 1 };
+    return plan;
+}
+
+
+/**
+* Returns a plan of one dimensional real transform of nPoints
+* samples. Forward plans transform the samples into nPoints/2+1
+* coefficients of the Hermitian spectrum, backward plans the inverse.
+* Each call must be paired with a Release call.
+* 
+* @param nPoints number of real samples
+*
+* @param type FFTW_FORWARD for r2c or FFTW_BACKWARD for c2r transform
+*
+* @param flags fftw planner flags
+*
+* @param spectrum pointer to the complex buffer of the caller
+*
+* @param samples pointer to the real buffer of the caller
+*
+* @return the plan, which may only be executed with fftw_execute_dft_r2c or fftw_execute_dft_c2r
+*
+*/
+fftw_plan FFTPlanCache::AcquireReal(int nPoints, int type, unsigned flags, fftw_complex *spectrum, double *samples)
+{
+    PlanKey key = { nPoints, 1, type, flags,
+                    fftw_alignment_of((double *) spectrum), fftw_alignment_of(samples), (double *) spectrum == samples, true };
+
+    std::lock_guard<std::mutex> lock(GetPlannerMutex());
+    fftw_plan plan = Find(key);
+    if(plan != NULL)
+    {
+        return plan;
+    }
+
+    char *wisdom = BeginPlanning(flags);
+    plan = (type == FFTW_FORWARD) ? fftw_plan_dft_r2c_1d(nPoints, samples, spectrum, flags) :
+                                    fftw_plan_dft_c2r_1d(nPoints, spectrum, samples, flags);
+    if(plan == NULL)
+    {
+        // No wisdom for this transform
+        GetMisses()++;
+        plan = (type == FFTW_FORWARD) ? fftw_plan_dft_r2c_1d(nPoints, samples, spectrum, FFTW_ESTIMATE) :
+                                        fftw_plan_dft_c2r_1d(nPoints, spectrum, samples, FFTW_ESTIMATE);
+    }
+    EndPlanning(wisdom);
+    GetRegistry()[key] = { plan, 1 };
+    return plan;
+}
+
+
+/**
+* Looks up the plan and takes a reference to it.
+* The planner mutex must be held.
+* 
+* @param key properties of the plan
+*
+* @return the plan, else NULL
+*
+*/
+fftw_plan FFTPlanCache::Find(const PlanKey &key)
+{
+    std::map<PlanKey, PlanEntry> &registry = GetRegistry();
+    auto entry = registry.find(key);
+    if(entry == registry.end())
+    {
+        return NULL;
+    }
+    entry->second.refCount++;
+    return entry->second.plan;
+}
+
+
+/**
+* Takes a snapshot of the wisdom before a plan which may
+* be measured is created. The planner mutex must be held.
+* 
+* @param flags fftw planner flags of the plan
+*
+* @return the wisdom to pass to EndPlanning, NULL if the plan can not add any
+*
+*/
+char * FFTPlanCache::BeginPlanning(unsigned flags)
+{
+    if( (flags & FFTW_ESTIMATE) || (flags & FFTW_WISDOM_ONLY) )
+    {
+        return NULL;
+    }
+    return fftw_export_wisdom_to_string();
+}
+
+
+/**
+* Advances the wisdom generation if planning has added
+* to the wisdom and frees the snapshot. The planner mutex must be held.
+* 
+* @param wisdom snapshot returned by BeginPlanning
+*
+*/
+void FFTPlanCache::EndPlanning(char *wisdom)
+{
+    if(wisdom == NULL)
+    {
+        return;
+    }
+    char *planned = fftw_export_wisdom_to_string();
+    if( (planned == NULL) || (strcmp(wisdom, planned) != 0) )
+    {
+        GetGeneration()++;
+    }
+    free(planned);
+    free(wisdom);
+}
+
+
+/**
+* @return counter of planning which added to the wisdom
+*/
+uint64_t & FFTPlanCache::GetGeneration()
+{
+    static uint64_t generation = 0;
+    return generation;
+}
+
+
+/**
+* @return counter of wisdom only plans estimated for the lack of wisdom
+*/
+uint64_t & FFTPlanCache::GetMisses()
+{
+    static uint64_t misses = 0;
+    return misses;
+}
+
+
+/**
+* Counts the plans which were requested with FFTW_WISDOM_ONLY
+* but estimated, because the wisdom has no entry for them. Plans 
+* planned from imported wisdom leave the count unchanged.
+* 
+* @return number of wisdom only plans estimated so far
+*
+*/
+uint64_t FFTPlanCache::GetWisdomMissCount()
+{
+    std::lock_guard<std::mutex> lock(GetPlannerMutex());
+    return GetMisses();
+}
+
+
+/**
+* Changes whenever a plan adds to the wisdom of the process,
+* wisdom only needs to be saved if it has changed since it was loaded.
+* 
+* @return the current wisdom generation
+*
+*/
+uint64_t FFTPlanCache::GetWisdomGeneration()
+{
+    std::lock_guard<std::mutex> lock(GetPlannerMutex());
+    return GetGeneration();
+}
+
+
+/**
+* Releases the plan acquired by Acquire call.
+* The plan is destroyed once it is no longer used.
+* 
+* @param plan the plan to release
+*
+*/
+void FFTPlanCache::Release(fftw_plan plan)
+{
+    std::lock_guard<std::mutex> lock(GetPlannerMutex());
+    std::map<PlanKey, PlanEntry> &registry = GetRegistry();
+    for(auto entry = registry.begin(); entry != registry.end(); entry++)
+    {
+        if(entry->second.plan == plan)
+        {
+            if(--entry->second.refCount == 0)
+            {
+                fftw_destroy_plan(plan);
+                registry.erase(entry);
+            }
+            return;
+        }
+    }
+}
+
+
+/**
+* @return number of plans currently held by the registry
+*/
+size_t FFTPlanCache::GetSize()
+{
+    std::lock_guard<std::mutex> lock(GetPlannerMutex());
+    return GetRegistry().size();
+}
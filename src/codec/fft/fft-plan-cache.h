@@ -0,0 +1,72 @@
+/**
+* @file fft-plan-cache.h
+* @author Kamil Rog
+*
+* @section DESCRIPTION
+*
+* Process wide registry of fftw plans. Objects transforming
+* the same size in the same direction share one plan, which 
+* they execute on their own buffers with fftw_execute_dft.
+* Plans are reference counted and destroyed once the last
+* object using them releases them.
+*/
+#ifndef FFT_PLAN_CACHE_H
+#define FFT_PLAN_CACHE_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <fftw3.h>
+
+
+/**
+ * @brief Thread safe, reference counted fftw plan registry
+ * 
+ */
+class FFTPlanCache {
+
+public:
+
+	static fftw_plan Acquire(int nPoints, int nTransforms, int type, unsigned flags, fftw_complex *in, fftw_complex *out);
+	static fftw_plan AcquireReal(int nPoints, int type, unsigned flags, fftw_complex *spectrum, double *samples);
+	static void Release(fftw_plan plan);
+	static size_t GetSize();
+	static std::mutex & GetPlannerMutex();
+	static uint64_t GetWisdomGeneration();
+	static uint64_t GetWisdomMissCount();
+
+private:
+
+	/**
+	 * @brief Properties of a plan which must match
+	 * for the plan to be executed on other buffers
+	 */
+	struct PlanKey {
+		int nPoints;
+		int nTransforms;
+		int type;
+		unsigned flags;
+		int inAlignment;
+		int outAlignment;
+		bool inPlace;
+		bool real;
+
+		bool operator<(const PlanKey &other) const;
+	};
+
+	struct PlanEntry {
+		fftw_plan plan;
+		size_t refCount;
+	};
+
+	static std::map<PlanKey, PlanEntry> & GetRegistry();
+	static fftw_plan Find(const PlanKey &key);
+	static char * BeginPlanning(unsigned flags);
+	static void EndPlanning(char *wisdom);
+	static uint64_t & GetGeneration();
+	static uint64_t & GetMisses();
+
+};
+
+#endif
@@ -7,6 +7,11 @@
 
 
 #include "ofdmfft.h"
+#include <algorithm>
+#include <cstdio>
+#include <cmath>
+#include <cstdlib>
+#include <sys/stat.h>
 
 
 /**
@@ -16,10 +21,15 @@
 * 
 * @param type Specifies whether the object computes FFT or IFFT choices - FFTW_FORWARD(-1) FFTW_BACKWARD(+1)
 *
+* @param effort planner effort used to create the plans
+*
+* @param transform complex or real time series, real transforms
+* require even number of points
+*
 * @return 0 on success, else error number
 *
 */
-int ofdmFFT::Configure(size_t nPoints, int type, size_t pilotStep)
+int ofdmFFT::Configure(size_t nPoints, int type, size_t pilotStep, PlannerEffort effort, TransformType transform)
 {   
     // If object has been configured before
     if(m_configured)
@@ -27,14 +37,46 @@ int ofdmFFT::Configure(size_t nPoints, int type, size_t pilotStep)
         // Destroy fft plan and free allocated memory to buffers
         Close();
     }
-    in = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * nPoints);
-    out = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * nPoints);
-    // Measure if many of the transforms of the siza are going to be performed
-    // otherwise use FFTW_ESTIMATE 
-    m_fftplan = fftw_plan_dft_1d(nPoints, in, out, type, FFTW_MEASURE); 
-
+    if( (transform == TRANSFORM_REAL) && (nPoints % 2) )
+    {
+        return -1;
+    }
+    m_transform = transform;
     m_nFFT = nPoints;
+    size_t nCoefficients = GetSpectrumSize();
+    in = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * nCoefficients);
+    out = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * nCoefficients);
+    switch(effort)
+    {
+        case PLANNER_ESTIMATE:      m_flags = FFTW_ESTIMATE; break;
+        case PLANNER_PATIENT:       m_flags = FFTW_PATIENT; break;
+        case PLANNER_WISDOM_ONLY:   m_flags = FFTW_MEASURE | FFTW_WISDOM_ONLY; break;
+        default:                    m_flags = FFTW_MEASURE; break;
+    }
+    m_type = type;
     m_pilotToneStep = pilotStep;
+    m_layout.Configure(nPoints, pilotStep, m_transform == TRANSFORM_REAL);
+
+    if(m_transform == TRANSFORM_REAL)
+    {
+        real = (double*) fftw_malloc(sizeof(double) * nPoints);
+        m_fftplan = FFTPlanCache::AcquireReal((int) nPoints, type, m_flags, (type == FFTW_FORWARD) ? out : in, real);
+        if(type == FFTW_FORWARD)
+        {
+            m_unalignedPlan = FFTPlanCache::AcquireReal((int) nPoints, type, m_flags | FFTW_UNALIGNED, out, real);
+        }
+        std::fill(real, real + nPoints, 0.0);
+    }
+    else
+    {
+        m_fftplan = FFTPlanCache::Acquire((int) nPoints, 1, type, m_flags, in, out);
+        if(type == FFTW_FORWARD)
+        {
+            m_unalignedPlan = FFTPlanCache::Acquire((int) nPoints, 1, type, m_flags | FFTW_UNALIGNED, in, out);
+        }
+    }
+    // Planning overwrites the buffers, clear coefficients which may never be set 
+    std::fill((double *) in, (double *) (in + nCoefficients), 0.0);
 
     // Set configure flag
     m_configured = 1;
@@ -43,20 +85,116 @@ int ofdmFFT::Configure(size_t nPoints, int type, size_t pilotStep)
 
 
 /**
-* Destroys fftw plan and frees up allocated memory for input and output buffers
+* Releases fftw plans and frees up allocated memory for input and output buffers
 * 
 * @return 0 on success, else error number
 *
 */    
 int ofdmFFT::Close()
 {
-    fftw_destroy_plan(m_fftplan);
+    if(!m_configured)
+    {
+        return 0;
+    }
+    FFTPlanCache::Release(m_fftplan);
+    if(m_unalignedPlan)
+    {
+        FFTPlanCache::Release(m_unalignedPlan);
+    }
     fftw_free(in); fftw_free(out);
+    fftw_free(real);
+    m_fftplan = nullptr;
+    m_unalignedPlan = nullptr;
+    real = nullptr;
+    // Batch is sized for the previous configuration
+    if(m_nBatch)
+    {
+        FFTPlanCache::Release(m_batchPlan);
+        fftw_free(batchIn); fftw_free(batchOut);
+        m_batchPlan = nullptr;
+        batchIn = nullptr;
+        batchOut = nullptr;
+        m_nBatch = 0;
+    }
     m_configured = 0;
     return 0;
 }
 
 
+/**
+* Sets up batch of transforms of the configured size and type
+* which are computed by single execution of the advanced
+* interface plan. Transform k reads batchIn[k*nPoints]
+* and writes batchOut[k*nPoints].
+* Reconfiguring the object discards the batch.
+* Batches of real transforms are not supported.
+* 
+* @param nBatch number of transforms in the batch
+*
+* @return 0 on success, else error number
+*
+*/
+int ofdmFFT::ConfigureBatch(size_t nBatch)
+{
+    // Object must be configured first
+    if(!m_configured || nBatch == 0 || m_transform == TRANSFORM_REAL)
+    {
+        return -1;
+    }
+    // Release the previous batch
+    if(m_nBatch)
+    {
+        FFTPlanCache::Release(m_batchPlan);
+        fftw_free(batchIn); fftw_free(batchOut);
+    }
+    batchIn = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * m_nFFT * nBatch);
+    batchOut = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * m_nFFT * nBatch);
+    m_batchPlan = FFTPlanCache::Acquire((int) m_nFFT, (int) nBatch, m_type, m_flags, batchIn, batchOut);
+    // Planning overwrites the buffers, clear coefficients which may never be set 
+    std::fill((double *) batchIn, (double *) (batchIn + m_nFFT * nBatch), 0.0);
+    m_nBatch = nBatch;
+    return 0;
+}
+
+
+/**
+* Computes all transforms of the batch
+* 
+* @return 0 on success, else error number
+*
+*/
+int ofdmFFT::ComputeBatchTransform()
+{
+    if(!m_nBatch)
+    {
+        return -1;
+    }
+    fftw_execute_dft(m_batchPlan, batchIn, batchOut);
+    return 0;
+}
+
+
+/**
+* Normalises the output of the first nTransforms transforms of the batch
+* 
+* @param nTransforms number of transforms to normalise
+*
+* @return 0 on success, else error number
+*
+*/
+int ofdmFFT::NormaliseBatch(size_t nTransforms)
+{
+    double multiplicationFactor = 1./m_nFFT;
+    size_t nPoints = m_nFFT * std::min(nTransforms, m_nBatch);
+    for (size_t i = 0; i < nPoints; i++)
+    {
+        batchOut[i][0] *= multiplicationFactor;
+        batchOut[i][1] *= multiplicationFactor;
+    }
+    return 0;
+}
+
+
 /**
 * Normalises the output of the FFT 
 * 
@@ -66,7 +204,8 @@ int ofdmFFT::Close()
 int ofdmFFT::Normalise()
 {
     double multiplicationFactor = 1./m_nFFT;
-    for (uint32_t i = 0; i < m_nFFT; i++)
+    size_t nCoefficients = GetSpectrumSize();
+    for (size_t i = 0; i < nCoefficients; i++)
     {
         out[i][0] *= multiplicationFactor;
         out[i][1] *= multiplicationFactor;
@@ -77,66 +216,94 @@ int ofdmFFT::Normalise()
 
 /**
 * Computes the sum of the imaginary points where 
-* pilot tones are expected
+* pilot tones are expected. Evenly spaced pilots of a misaligned 
+* Hermitian spectrum rotate by evenly spaced angles, whose signed
+* imaginary parts cancel out, so real transforms sum the magnitudes.
 * 
-* @return symbol start(integer) index, else -1
+* @param nBytes number of bytes encoded in the symbol
+*
+* @return sum of the imaginary parts of the pilot tones
 *
 */
 double ofdmFFT::GetImagSum(size_t nBytes) 
 {
+    const std::vector<size_t> &pilots = GetLayout(nBytes).GetPilotIndices();
     double sumOfImag = 0.0;
-    size_t pilotToneCounter =  (int) m_pilotToneStep / 2 ; // divide this by to when starting with -ve frequencies
-    size_t fftPointIndex = (int) ((m_nFFT*2) - (m_nFFT*2) / m_pilotToneStep / 2 - nBytes * 4 / 2);
-    fftPointIndex = (int) fftPointIndex / 2;
-    size_t insertionCounter = 0;
-    // For expected byte 
-    for(size_t byteCounter = 0; byteCounter < nBytes; byteCounter++)
-    {
-        insertionCounter = 0;
-        // Process 4 FFT points i.e 8 bits
-        while(insertionCounter < 4)
+    if(m_transform == TRANSFORM_REAL)
+    {
+        for(size_t pilot : pilots)
         {
-            // If pilot tone counter counted down
-            // This point is the pilot tone
-            if(pilotToneCounter == 0)
-            {
-                // Reset Counter
-                pilotToneCounter = m_pilotToneStep;
-                sumOfImag += out[fftPointIndex][1];
-    
-            }
-            // This point is QAM encoded complex point
-            else
-            {
-                insertionCounter++;
-                pilotToneCounter--;
-            }
-            // Increment fft point counter
-            fftPointIndex++;
-            // Check if fft exceeds the limit of points
-            if(fftPointIndex == m_nFFT)
-            {
-                // Roll back to positive frequencies
-                fftPointIndex = 0;
-            }
+            sumOfImag += std::abs(out[pilot][1]);
         }
-
+        return sumOfImag;
+    }
+    for(size_t pilot : pilots)
+    {
+        sumOfImag += out[pilot][1];
     }
-    // Return sum
     return sumOfImag;
 }
 
 
 /**
-* Computes FFT Based on the object's input (in) buffer and stores it in the object's output (out) buffer.
+* Computes the subcarrier layout of a symbol carrying nBytes
+* QAM encoded bytes.
 * 
+* @param nBytes number of bytes encoded in the symbol
+*
+* @return layout of the data points and pilot tones
+*
+*/
+const SubcarrierLayout &ofdmFFT::GetLayout(size_t nBytes)
+{
+    m_layout.Update( (nBytes * 8 + m_bitsPerSymbol - 1) / m_bitsPerSymbol );
+    return m_layout;
+}
+
+
+/**
+* Sets the QAM order of the symbols, 4-QAM by default
+* 
+* @param bitsPerSymbol number of bits of each QAM point
+*
+* @return 0 on success, else error number
+*
+*/
+int ofdmFFT::SetBitsPerSymbol(size_t bitsPerSymbol)
+{
+    if(bitsPerSymbol == 0)
+    {
+        return -1;
+    }
+    m_bitsPerSymbol = bitsPerSymbol;
+    return 0;
+}
+
+
+/**
+* Computes FFT Based on the object's input (in) buffer and stores it in the object's output (out) buffer.
+* Real transforms compute the forward transform from the real buffer 
+* and the inverse transform into the real buffer.
 *
 * @return 0 on success, else error number
 *
 */    
 int ofdmFFT::ComputeTransform()
 {
-    fftw_execute(m_fftplan);
+    if(m_transform == TRANSFORM_REAL)
+    {
+        if(m_type == FFTW_FORWARD)
+        {
+            fftw_execute_dft_r2c(m_fftplan, real, out);
+        }
+        else
+        {
+            // Inverse real transform overwrites the input
+            fftw_execute_dft_c2r(m_fftplan, in, real);
+        }
+        return 0;
+    }
+    fftw_execute_dft(m_fftplan, in, out);
     return 0;
 }
 
@@ -148,11 +315,154 @@ int ofdmFFT::ComputeTransform()
 * @param dest pointer to the fftw_complex array
 *
 *
-* @return 0 on success, else error number
+* @return 0 on success, -1 for real transforms
 *
 */   
 int ofdmFFT::ComputeTransform(fftw_complex *dest)
 {
+    if(m_transform == TRANSFORM_REAL)
+    {
+        return -1;
+    }
     fftw_execute_dft(m_fftplan, in, dest);
     return 0;
 }
+
+
+/**
+* Computes the forward transform directly from the received
+* samples into the object's output (out) buffer, so the samples 
+* are not copied into the input buffer first. Samples aligned
+* like the input buffer use the configured plan, others the
+* plan created for unaligned arrays. Complex transforms read
+* nPoints interleaved real and imag pairs, real transforms
+* nPoints real samples. The samples are not modified.
+* 
+* @param samples pointer to the first sample of the symbol
+*
+* @return 0 on success, -1 for inverse transforms
+*
+*/   
+int ofdmFFT::ComputeTransform(const double *samples)
+{
+    if(!m_unalignedPlan)
+    {
+        return -1;
+    }
+    // Out of place forward plans preserve their input
+    double *input = const_cast<double *>(samples);
+    if(m_transform == TRANSFORM_REAL)
+    {
+        bool aligned = (fftw_alignment_of(input) == fftw_alignment_of(real));
+        fftw_execute_dft_r2c(aligned ? m_fftplan : m_unalignedPlan, input, out);
+        return 0;
+    }
+    bool aligned = (fftw_alignment_of(input) == fftw_alignment_of((double *) in));
+    fftw_execute_dft(aligned ? m_fftplan : m_unalignedPlan, (fftw_complex *) input, out);
+    return 0;
+}
+
+
+/**
+* Adds the wisdom stored in a file to the wisdom of the process.
+* Plans created afterwards skip measurement of the known transforms.
+* 
+* @param fileName path to the wisdom file
+*
+* @return 0 on success, else error number
+*
+*/
+int ofdmFFT::ImportWisdom(const std::string &fileName)
+{
+    std::lock_guard<std::mutex> lock(FFTPlanCache::GetPlannerMutex());
+    return fftw_import_wisdom_from_filename(fileName.c_str()) ? 0 : -1;
+}
+
+
+/**
+* Stores the wisdom of the process in a file. The wisdom is written
+* to a uniquely named temporary file first and renamed over the file,
+* so neither a concurrent reader nor another writing process
+* ever sees a partially written file.
+* 
+* @param fileName path to the wisdom file
+*
+* @return 0 on success, else error number
+*
+*/
+int ofdmFFT::ExportWisdom(const std::string &fileName)
+{
+    std::vector<char> tempName(fileName.begin(), fileName.end());
+    const char suffix[] = ".XXXXXX";
+    tempName.insert(tempName.end(), suffix, suffix + sizeof(suffix));
+    std::lock_guard<std::mutex> lock(FFTPlanCache::GetPlannerMutex());
+    int fd = mkstemp(tempName.data());
+    if(fd < 0)
+    {
+        return -1;
+    }
+    // mkstemp creates the file readable by the owner only
+    fchmod(fd, 0644);
+    FILE *file = fdopen(fd, "w");
+    if(file == NULL)
+    {
+        close(fd);
+        unlink(tempName.data());
+        return -1;
+    }
+    fftw_export_wisdom_to_file(file);
+    bool failed = (ferror(file) != 0);
+    if( (fclose(file) != 0) || failed )
+    {
+        unlink(tempName.data());
+        return -1;
+    }
+    if(std::rename(tempName.data(), fileName.c_str()) != 0)
+    {
+        unlink(tempName.data());
+        return -1;
+    }
+    return 0;
+}
+
+
+/**
+* Adds the wisdom held in a string to the wisdom of the process.
+* 
+* @param wisdom string produced by ExportWisdomString
+*
+* @return 0 on success, else error number
+*
+*/
+int ofdmFFT::ImportWisdomString(const std::string &wisdom)
+{
+    std::lock_guard<std::mutex> lock(FFTPlanCache::GetPlannerMutex());
+    return fftw_import_wisdom_from_string(wisdom.c_str()) ? 0 : -1;
+}
+
+
+/**
+* @return the wisdom of the process as a string
+*/
+std::string ofdmFFT::ExportWisdomString()
+{
+    std::lock_guard<std::mutex> lock(FFTPlanCache::GetPlannerMutex());
+    char *wisdom = fftw_export_wisdom_to_string();
+    if(wisdom == NULL)
+    {
+        return std::string();
+    }
+    std::string result(wisdom);
+    free(wisdom);
+    return result;
+}
+
+
+/**
+* Discards the wisdom of the process, existing plans are not affected.
+*/
+void ofdmFFT::ForgetWisdom()
+{
+    std::lock_guard<std::mutex> lock(FFTPlanCache::GetPlannerMutex());
+    fftw_forget_wisdom();
+}
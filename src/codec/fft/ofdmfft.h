@@ -15,8 +15,40 @@
 #include <iostream>
 #include <math.h>
 #include <fftw3.h>
+#include <vector>
 
 #include "common.h"
+#include "fft-plan-cache.h"
+#include "subcarrier-layout.h"
+
+
+/**
+ * @brief Planner effort used when creating fftw plans.
+ * PLANNER_WISDOM_ONLY never measures, it uses the imported
+ * wisdom and falls back to an estimated plan without it, 
+ * counted by FFTPlanCache::GetWisdomMissCount().
+ *
+ */
+enum PlannerEffort {
+	PLANNER_ESTIMATE,
+	PLANNER_MEASURE,
+	PLANNER_PATIENT,
+	PLANNER_WISDOM_ONLY
+};
+
+
+/**
+ * @brief Kind of the time series produced by the transform.
+ * TRANSFORM_COMPLEX transforms nPoints complex samples, which 
+ * are Nyquist modulated into a real signal of 2*nPoints samples.
+ * TRANSFORM_REAL transforms nPoints real samples directly using 
+ * the Hermitian symmetric spectrum of nPoints/2+1 coefficients.
+ *
+ */
+enum TransformType {
+	TRANSFORM_COMPLEX,
+	TRANSFORM_REAL
+};
 
 
 /**
@@ -42,13 +74,15 @@ public:
 	* 
 	* @param nPoints Number(uint16_t) of FFT / IFFT coefficients
 	* @param type Specifies whether the object computes FFT or IFFT choices - FFTW_FORWARD(-1) FFTW_BACKWARD(+1)
+	* @param effort planner effort used to create the plans
+	* @param transform complex or real time series
 	*
 	* @return -
 	*
 	*/
-	ofdmFFT(size_t nPoints, int type, uint32_t pilotStep)
+	ofdmFFT(size_t nPoints, int type, uint32_t pilotStep, PlannerEffort effort = PLANNER_MEASURE, TransformType transform = TRANSFORM_COMPLEX)
 	{
-		Configure(nPoints, type, pilotStep);
+		Configure(nPoints, type, pilotStep, effort, transform);
 	}
 
 	/**
@@ -62,25 +96,92 @@ public:
 		Close();
 	}
 
-	int Configure(size_t nPoints, int type, size_t pilotStep);
+	int Configure(size_t nPoints, int type, size_t pilotStep, PlannerEffort effort = PLANNER_MEASURE, TransformType transform = TRANSFORM_COMPLEX);
 	int Normalise();
 	int Close();
 	int ComputeTransform();
 	int ComputeTransform(fftw_complex *dest);
+	int ComputeTransform(const double *samples);
 	double GetImagSum(size_t nBytes);
+	const SubcarrierLayout &GetLayout(size_t nBytes);
+	int SetBitsPerSymbol(size_t bitsPerSymbol);
+	TransformType GetTransformType() const;
+	size_t GetSize() const;
+	size_t GetSpectrumSize() const;
+
+	// Batch Related Functions //
+	int ConfigureBatch(size_t nBatch);
+	int ComputeBatchTransform();
+	int NormaliseBatch(size_t nTransforms);
+	size_t GetBatchSize() const;
+
+	// Wisdom Related Functions //
+	static int ImportWisdom(const std::string &fileName);
+	static int ExportWisdom(const std::string &fileName);
+	static int ImportWisdomString(const std::string &wisdom);
+	static std::string ExportWisdomString();
+	static void ForgetWisdom();
 
 public:
 
 	fftw_complex *in; /// Input buffer for the (I)FFT algorithm.
 	fftw_complex *out; // Output buffer, the results of fft execution is put into this after Exectue() call
+	double *real = nullptr; /// Real time series, output of the inverse and input of the forward real transform
+	fftw_complex *batchIn = nullptr; /// Input buffer of the batch, nBatch transforms each nPoints apart
+	fftw_complex *batchOut = nullptr; /// Output buffer of the batch, same layout as the input
 
 private:
 
 	size_t m_nFFT = 0;
 	size_t m_pilotToneStep = 0;
+	int m_type = 0;
+	TransformType m_transform = TRANSFORM_COMPLEX;
+	unsigned m_flags = FFTW_MEASURE;
 	int m_configured = 0;
-    fftw_plan m_fftplan; /// FFT plan 
+	fftw_plan m_fftplan = nullptr; /// FFT plan, shared through the plan cache
+	fftw_plan m_unalignedPlan = nullptr; /// Forward plan reading samples of any alignment, see ComputeTransform(const double *)
+	size_t m_nBatch = 0;
+	fftw_plan m_batchPlan = nullptr; /// Plan computing nBatch transforms in one execution
+	SubcarrierLayout m_layout;
+	size_t m_bitsPerSymbol = 2; /// Bits of each QAM point, determines the layout of nBytes
 
 };
 
+
+
+/**
+* @return kind of the time series the object transforms
+*/
+inline TransformType ofdmFFT::GetTransformType() const
+{
+	return m_transform;
+}
+
+
+/**
+* @return number of points of the transform
+*/
+inline size_t ofdmFFT::GetSize() const
+{
+	return m_nFFT;
+}
+
+
+/**
+* @return number of complex coefficients in the in and out buffers
+*/
+inline size_t ofdmFFT::GetSpectrumSize() const
+{
+	return (m_transform == TRANSFORM_REAL) ? m_nFFT/2 + 1 : m_nFFT;
+}
+
+
+/**
+* @return number of transforms computed by one batch execution, 0 if not configured
+*/
+inline size_t ofdmFFT::GetBatchSize() const
+{
+	return m_nBatch;
+}
+
 #endif
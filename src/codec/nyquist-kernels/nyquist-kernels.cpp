@@ -0,0 +1,208 @@
+/**
+* @file nyquist-kernels.cpp
+* @author Kamil Rog
+*
+*
+*/
+
+
+#include "nyquist-kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NYQUIST_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+
+/**
+* Copies nPoints complex samples negating every other sample,
+* starting from the second. Input and output may be the same
+* buffer but must not partially overlap.
+*
+* @param input pointer to the interleaved real and imag pairs
+*
+* @param output pointer to the destination of nPoints pairs
+*
+* @param nPoints number of complex samples
+*
+*/
+static void AlternateScalar(const double *input, double *output, size_t nPoints)
+{
+    size_t i = 0;
+    for(; i + 1 < nPoints; i += 2)
+    {
+        output[i*2] = input[i*2];
+        output[i*2+1] = input[i*2+1];
+        output[i*2+2] = -input[i*2+2];
+        output[i*2+3] = -input[i*2+3];
+    }
+    // Odd number of points ends on a positive sample
+    if(i < nPoints)
+    {
+        output[i*2] = input[i*2];
+        output[i*2+1] = input[i*2+1];
+    }
+}
+
+
+#ifdef NYQUIST_KERNELS_X86
+
+/**
+* SSE2 kernel, the second sample of each pair has its sign
+* bits flipped.
+*
+*/
+__attribute__((target("sse2")))
+static void AlternateSSE2(const double *input, double *output, size_t nPoints)
+{
+    const __m128d signBit = _mm_set1_pd(-0.0);
+    size_t i = 0;
+    for(; i + 1 < nPoints; i += 2)
+    {
+        __m128d even = _mm_loadu_pd(&input[i*2]);
+        __m128d odd = _mm_loadu_pd(&input[i*2+2]);
+        _mm_storeu_pd(&output[i*2], even);
+        _mm_storeu_pd(&output[i*2+2], _mm_xor_pd(odd, signBit));
+    }
+    if(i < nPoints)
+    {
+        _mm_storeu_pd(&output[i*2], _mm_loadu_pd(&input[i*2]));
+    }
+}
+
+
+/**
+* AVX kernel, each 256 bit register holds a pair of samples
+* starting at an even sample, so a single mask covers every
+* register. Two registers are processed per iteration.
+*
+*/
+__attribute__((target("avx")))
+static void AlternateAVX(const double *input, double *output, size_t nPoints)
+{
+    const __m256d signMask = _mm256_set_pd(-0.0, -0.0, 0.0, 0.0);
+    size_t i = 0;
+    for(; i + 3 < nPoints; i += 4)
+    {
+        __m256d first = _mm256_loadu_pd(&input[i*2]);
+        __m256d second = _mm256_loadu_pd(&input[i*2+4]);
+        _mm256_storeu_pd(&output[i*2], _mm256_xor_pd(first, signMask));
+        _mm256_storeu_pd(&output[i*2+4], _mm256_xor_pd(second, signMask));
+    }
+    if(i + 1 < nPoints)
+    {
+        _mm256_storeu_pd(&output[i*2], _mm256_xor_pd(_mm256_loadu_pd(&input[i*2]), signMask));
+        i += 2;
+    }
+    if(i < nPoints)
+    {
+        _mm_storeu_pd(&output[i*2], _mm_loadu_pd(&input[i*2]));
+    }
+}
+
+#endif
+
+
+/**
+* Multiplies each complex sample by (-1)^n while copying it,
+* used by both the modulator and the demodulator.
+*
+* @param input pointer to the first of nPoints interleaved samples
+*
+* @param output pointer to the destination, may equal input
+*
+* @param nPoints number of complex samples
+*
+*/
+void NyquistKernels::Alternate(const double *input, double *output, size_t nPoints)
+{
+    GetSelected().load(std::memory_order_relaxed)->alternate(input, output, nPoints);
+}
+
+
+/**
+* @return instruction set of the kernels in use
+*/
+NyquistKernelSet NyquistKernels::GetKernelSet()
+{
+    return GetSelected().load(std::memory_order_relaxed)->kernelSet;
+}
+
+
+/**
+* Overrides the runtime selection, mainly for benchmarking
+* the kernels against each other.
+*
+* @param kernelSet instruction set of the kernels to use
+*
+* @return 0 on success, -1 if the CPU does not support it
+*
+*/
+int NyquistKernels::SetKernelSet(NyquistKernelSet kernelSet)
+{
+    if(!IsSupported(kernelSet))
+    {
+        return -1;
+    }
+    GetSelected().store(GetTable(kernelSet), std::memory_order_relaxed);
+    return 0;
+}
+
+
+/**
+* @param kernelSet instruction set of the kernels
+*
+* @return true if the CPU executing the process supports it
+*
+*/
+bool NyquistKernels::IsSupported(NyquistKernelSet kernelSet)
+{
+    switch(kernelSet)
+    {
+#ifdef NYQUIST_KERNELS_X86
+        case NYQUIST_KERNEL_AVX:    return __builtin_cpu_supports("avx");
+        case NYQUIST_KERNEL_SSE2:   return __builtin_cpu_supports("sse2");
+#endif
+        case NYQUIST_KERNEL_SCALAR: return true;
+        default:                    return false;
+    }
+}
+
+
+/**
+* @param kernelSet instruction set of the kernels
+*
+* @return table of the kernels, scalar if not compiled in
+*
+*/
+const NyquistKernels::KernelTable *NyquistKernels::GetTable(NyquistKernelSet kernelSet)
+{
+    static const KernelTable scalar = { NYQUIST_KERNEL_SCALAR, AlternateScalar };
+#ifdef NYQUIST_KERNELS_X86
+    static const KernelTable sse2 = { NYQUIST_KERNEL_SSE2, AlternateSSE2 };
+    static const KernelTable avx = { NYQUIST_KERNEL_AVX, AlternateAVX };
+    switch(kernelSet)
+    {
+        case NYQUIST_KERNEL_AVX:    return &avx;
+        case NYQUIST_KERNEL_SSE2:   return &sse2;
+        default:                    break;
+    }
+#endif
+    return &scalar;
+}
+
+
+/**
+* Kernels in use, the widest supported set is selected on first use.
+*
+* @return reference to the selected kernel table
+*
+*/
+std::atomic<const NyquistKernels::KernelTable *> & NyquistKernels::GetSelected()
+{
+    static std::atomic<const KernelTable *> selected(
+        IsSupported(NYQUIST_KERNEL_AVX) ? GetTable(NYQUIST_KERNEL_AVX) :
+        IsSupported(NYQUIST_KERNEL_SSE2) ? GetTable(NYQUIST_KERNEL_SSE2) :
+        GetTable(NYQUIST_KERNEL_SCALAR));
+    return selected;
+}
@@ -0,0 +1,65 @@
+/**
+* @file nyquist-kernels.h
+* @author Kamil Rog
+*
+* @section DESCRIPTION
+*
+* Vectorised nyquist modulator kernels. Both the modulator and
+* the demodulator multiply the n-th complex sample by (-1)^n,
+* which for even and odd transform sizes alike negates every
+* other sample starting from the second. The SSE2 and AVX
+* kernels flip the sign bits of a pair of samples with a single
+* XOR against a sign mask, the scalar kernel negates each value.
+* Negation is exact, so all kernels produce identical bits.
+* The widest kernel supported by the CPU is chosen at runtime.
+*/
+#ifndef NYQUIST_KERNELS_H
+#define NYQUIST_KERNELS_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <atomic>
+
+
+/**
+ * @brief Instruction set used by the kernels
+ *
+ */
+enum NyquistKernelSet {
+	NYQUIST_KERNEL_SCALAR,
+	NYQUIST_KERNEL_SSE2,
+	NYQUIST_KERNEL_AVX
+};
+
+
+/**
+ * @brief Runtime dispatched nyquist modulation kernels
+ *
+ */
+class NyquistKernels {
+
+public:
+
+	static void Alternate(const double *input, double *output, size_t nPoints);
+	static NyquistKernelSet GetKernelSet();
+	static int SetKernelSet(NyquistKernelSet kernelSet);
+	static bool IsSupported(NyquistKernelSet kernelSet);
+
+private:
+
+	using AlternateFunction = void (*)(const double *, double *, size_t);
+
+	/**
+	 * @brief Kernels of one instruction set
+	 */
+	struct KernelTable {
+		NyquistKernelSet kernelSet;
+		AlternateFunction alternate;
+	};
+
+	static const KernelTable *GetTable(NyquistKernelSet kernelSet);
+	static std::atomic<const KernelTable *> & GetSelected();
+
+};
+
+#endif
@@ -6,6 +6,7 @@
 */
 
 #include "nyquist-modulator.h"
+#include "nyquist-kernels.h"
 #include <cstddef>
 
 /**
@@ -103,44 +104,46 @@ int NyquistModulator::Modulate(DoubleVec &vectorBuffer)
 * 
 * @param ifftOutput reference to the IFFT output buffer
 *
+* @param prefixSize number of samples preceding the symbol in the buffer
+*
 * @return 0 on success, else error number
 * 
 */  
 void NyquistModulator::Modulate(DoubleVec &ifftOutput, const size_t prefixSize)
 {
-    // If the nPoints is even
-    if( (m_nPoints % 2) == 0)
-    {      
-        // Initialize double buffer counter
-        // For each every other real img pair skipping first fft point
-        for(size_t i = prefixSize+2; i < prefixSize+(m_symbolSize); i+=4)
-        {
-            // Negate the value
-            ifftOutput[i] = -ifftOutput[i];
-            ifftOutput[i+1] = -ifftOutput[i+1];
-        }
-    }
-    // nPoints must be odd 
-    else
-    {
-        // Initialize +1 / -1 multiplier
-        int s = 1;
-        // Initialize double buffer counter
-        size_t j = 0;
-        for(size_t i = 0; i < m_nPoints; i++) 
-        {
-            // Copy the real part of the sample and multiply by s factor
-            ifftOutput[j]   = s * ifftOutput[j];
-            // Increment double buffer counter
-            j++;
-            // Copy the imag part of the sample and multiply by s factor
-            ifftOutput[j] = s * ifftOutput[j];
-            // Increment double buffer counter
-            j++;
-            // Compute factor for next sample
-            s *= -1;
-        }
-    }
+    Modulate(&ifftOutput[prefixSize]);
+}
+
+
+/**
+* Modulates the IFFT output in place, the symbol pointer
+* must point to the first real sample of the symbol 
+* i.e. just after its cyclic prefix.
+* 
+* @param symbol pointer to the interleaved IFFT output
+*
+*/  
+void NyquistModulator::Modulate(double *symbol)
+{
+    // Negate every other sample, the same for even and odd nPoints
+    NyquistKernels::Alternate(symbol, symbol, m_nPoints);
+}
+
+
+/**
+* Modulates the IFFT output while copying it into
+* the symbol, so the IFFT can write into a separate buffer
+* i.e. one of the transforms in a batch
+* 
+* @param ifftOutput pointer to the nPoints complex IFFT output
+*
+* @param symbol pointer to the first real sample of the symbol,
+* just after its cyclic prefix
+*
+*/  
+void NyquistModulator::Modulate(const fftw_complex *ifftOutput, double *symbol)
+{
+    NyquistKernels::Alternate( (const double *) ifftOutput, symbol, m_nPoints);
 }
 
 
@@ -154,46 +157,36 @@ void NyquistModulator::Modulate(DoubleVec &ifftOutput, const size_t prefixSize)
 */   
 void NyquistModulator::Demodulate(const DoubleVec &vectorBuffer, size_t offset)
 {
-    // If the nPoints is even
-    if(m_nPoints % 2 == 0)
-    {
-        // Initialize double buffer counter
-        size_t j = offset;
-        // For each expected FFT sample point
-        for (size_t i = 0; i < m_nPoints; i += 2)
-        {   
-            // Copy first first sample's real and img respectivley
-            pComplexBuffer[i][0] = vectorBuffer[j];
-            j++;
-            pComplexBuffer[i][1] = vectorBuffer[j];
-            j++;
-            // Copy and the minus real and img respectivley of next the sample
-            pComplexBuffer[i+1][0] = -vectorBuffer[j];
-            j++;
-            pComplexBuffer[i+1][1] = -vectorBuffer[j];
-            j++;
-        }
-    }
-    // nPoints must be odd
-    else
-    {
-        // Initialize +1 / -1 multiplier
-        int s = 1;
-        // Initialize double buffer counter
-        size_t j = offset;
-        // For each expected FFT sample point
-        for(size_t i = 0; i < m_nPoints; i++)
-        {
-            // Copy the real part of the sample and multiply by s factor
-            pComplexBuffer[i][0] = s * vectorBuffer[j];
-            // Increment double buffer counter
-            j++;
-            // Copy the imag part of the sample and multiply by s factor
-            pComplexBuffer[i][1] = s * vectorBuffer[j];
-            // Increment double buffer counter
-            j++;
-            // Compute factor for next sample
-            s *= -1;
-        }
-    }
+    Demodulate(vectorBuffer.data(), offset);
+}
+
+
+/**
+* Demodulates the Rx Samples into the complex fft input buffer
+*
+* @param vectorBuffer pointer to the Rx signal samples
+*
+* @param offset Points to start of the symbol in the Rx signal buffer. 
+*
+*/   
+void NyquistModulator::Demodulate(const double *vectorBuffer, size_t offset)
+{
+    Demodulate(vectorBuffer, offset, pComplexBuffer);
+}
+
+
+/**
+* Demodulates the Rx Samples into specified complex buffer,
+* i.e. one of the transforms in a batch
+*
+* @param vectorBuffer pointer to the Rx signal samples
+*
+* @param offset Points to start of the symbol in the Rx signal buffer. 
+*
+* @param dest pointer to the complex buffer of nPoints elements
+*
+*/   
+void NyquistModulator::Demodulate(const double *vectorBuffer, size_t offset, fftw_complex *dest)
+{
+    NyquistKernels::Alternate(&vectorBuffer[offset], (double *) dest, m_nPoints);
 }
\ No newline at end of file
@@ -67,7 +67,11 @@ public:
 	int Configure(size_t fftPoints, fftw_complex *pComplex);
 	int Close();
 	void Modulate(DoubleVec &ifftOutput, const size_t prefixSize);
+	void Modulate(double *symbol);
+	void Modulate(const fftw_complex *ifftOutput, double *symbol);
 	void Demodulate(const DoubleVec &vectorBuffer, const size_t offset);
+	void Demodulate(const double *vectorBuffer, const size_t offset);
+	void Demodulate(const double *vectorBuffer, const size_t offset, fftw_complex *dest);
 
 private:
 
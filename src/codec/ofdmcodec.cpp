@@ -13,6 +13,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <iostream>
+#include <algorithm>
 #include "ofdmcodec.h"
 
 
@@ -31,17 +32,273 @@
 */
 DoubleVec OFDMCodec::Encode(const ByteVec &input, size_t nBytes)
 {
+    auto start = m_monitor.Start();
     DoubleVec output;
-    output.resize(m_Settings.nPoints*2 + m_Settings.cyclicPrefixSize);
+    output.resize(GetSymbolSize());
+    EncodeSymbol(input.data(), nBytes, output.data());
+    m_monitor.Record(MONITOR_ENCODE, start, GetSymbolPeriod());
+    return output;
+}
+
+
+/**
+* Encodes one OFDM Symbol into caller provided buffer.
+* This function does not allocate any memory.
+* 
+* @param input pointer to the input data bytes
+*
+* @param nBytes number of bytes encoded in the symbol
+*
+* @param output pointer to the destination buffer
+*
+* @param outputSize number of samples the destination can hold,
+* must be at least GetSymbolSize()
+*
+* @return 0 on success, else -1
+*
+*/
+int OFDMCodec::Encode(const uint8_t *input, size_t nBytes, double *output, size_t outputSize)
+{
+    if( (outputSize < GetSymbolSize()) || (nBytes > GetSymbolCapacity()) )
+    {
+        return -1;
+    }
+    auto start = m_monitor.Start();
+    EncodeSymbol(input, nBytes, output);
+    m_monitor.Record(MONITOR_ENCODE, start, GetSymbolPeriod());
+    return 0;
+}
+
+
+/**
+* Encodes an arbitrary number of bytes into a frame of
+* back-to-back symbols, each preceded by its cyclic prefix.
+* Every symbol carries GetSymbolCapacity() bytes, the last
+* symbol is padded with zeros.
+* 
+* @param input reference to input data byte vector
+*
+* @param nBytes number of bytes to be encoded in the frame
+*
+* @return vector containing the encoded frame
+*
+*/
+DoubleVec OFDMCodec::EncodeFrame(const ByteVec &input, size_t nBytes)
+{
+    DoubleVec output;
+    EncodeFrame(input, nBytes, output);
+    return output;
+}
+
+
+/**
+* Encodes an arbitrary number of bytes into a frame of
+* symbols, each followed by guardInterval zero samples. The output is resized once to hold
+* the whole frame, so reusing the same vector for frames
+* of equal or smaller size does not allocate.
+* 
+* @param input reference to input data byte vector
+*
+* @param nBytes number of bytes to be encoded in the frame
+*
+* @param output reference to the destination sample vector
+*
+* @return number of symbols in the frame, 0 if nBytes exceeds
+* the input or the symbols carry no data
+*
+*/
+size_t OFDMCodec::EncodeFrame(const ByteVec &input, size_t nBytes, DoubleVec &output)
+{
+    auto start = m_monitor.Start();
+    size_t capacity = GetSymbolCapacity();
+    size_t symbolPeriod = GetSymbolPeriod();
+    if( (capacity == 0) || (nBytes > input.size()) )
+    {
+        output.clear();
+        return 0;
+    }
+    output.resize(GetFrameSize(nBytes));
+    size_t nSymbols = 0;
+    size_t byteOffset = 0;
+    // Encode full batches of symbols if configured
+    size_t nBatch = m_fft.GetBatchSize();
+    while( (nBatch > 1) && (byteOffset + nBatch*capacity <= nBytes) )
+    {
+        EncodeBatch(&input[byteOffset], &output[nSymbols*symbolPeriod]);
+        byteOffset += nBatch*capacity;
+        nSymbols += nBatch;
+    }
+    // Encode remaining full symbols straight from the input 
+    while(byteOffset + capacity <= nBytes)
+    {
+        EncodeSymbol(&input[byteOffset], capacity, &output[nSymbols*symbolPeriod]);
+        byteOffset += capacity;
+        nSymbols++;
+    }
+    // Pad the remaining bytes to fill the last symbol
+    if(byteOffset < nBytes)
+    {
+        std::fill(m_padBuffer.begin(), m_padBuffer.end(), 0);
+        std::copy(input.begin()+byteOffset, input.begin()+nBytes, m_padBuffer.begin());
+        EncodeSymbol(m_padBuffer.data(), capacity, &output[nSymbols*symbolPeriod]);
+        nSymbols++;
+    }
+    // Silence the guard interval after each symbol
+    if(m_Settings.guardInterval > 0)
+    {
+        for(size_t k = 0; k < nSymbols; k++)
+        {
+            std::fill_n(&output[k*symbolPeriod + GetSymbolSize()], m_Settings.guardInterval, 0.0);
+        }
+    }
+    m_monitor.Record(MONITOR_ENCODE, start, nSymbols*symbolPeriod);
+    return nSymbols;
+}
+
+
+/**
+* Encodes one OFDM Symbol into the specified location
+* 
+* @param input pointer to the first byte encoded in the symbol
+*
+* @param nBytes number of bytes encoded in the symbol
+*
+* @param symbol pointer to the destination, start of the prefix
+*
+*/
+void OFDMCodec::EncodeSymbol(const uint8_t *input, size_t nBytes, double *symbol)
+{
+    PROFILE_SCOPE(&m_profiler, PROFILE_ENCODE);
     // QAM Encode data block
-    m_qam.Modulate(input, (DoubleVec &) m_fft.in, nBytes);
-    // Transform data and put into the 
-    m_fft.ComputeTransform( (fftw_complex *) &output[GetSettings().cyclicPrefixSize]);
-    // Run nyquist modulator
-    m_NyquistModulator.Modulate( output, GetSettings().cyclicPrefixSize);
+    {
+        PROFILE_SCOPE(&m_profiler, PROFILE_QAM_MODULATE);
+        m_qam.Modulate(input, (double *) m_fft.in, nBytes);
+    }
+    PROFILE_SCOPE(&m_profiler, PROFILE_IFFT);
+    if(m_Settings.transform == TRANSFORM_REAL)
+    {
+        // Real time series needs no nyquist modulation
+        m_fft.ComputeTransform();
+        std::copy(m_fft.real, m_fft.real + m_Settings.nPoints, &symbol[GetSettings().cyclicPrefixSize]);
+    }
+    else
+    {
+        // Transform data and put into the 
+        m_fft.ComputeTransform( (fftw_complex *) &symbol[GetSettings().cyclicPrefixSize]);
+        // Rotated spectrum is Nyquist modulated by the transform
+        if(!m_spectralRotation)
+        {
+            m_NyquistModulator.Modulate(&symbol[GetSettings().cyclicPrefixSize]);
+        }
+    }
     // Add cyclic prefix
-    AddCyclicPrefix(output, GetSettings().nPoints*2 , GetSettings().cyclicPrefixSize);
-    return output;
+    AddCyclicPrefix(symbol, GetSymbolSamples(), GetSettings().cyclicPrefixSize);
+}
+
+
+/**
+* Encodes full batch of symbols, each carrying GetSymbolCapacity() bytes.
+* All symbols are transformed by single execution of the batch plan.
+* 
+* @param input pointer to the first byte of the batch
+*
+* @param output pointer to the destination, start of the first prefix,
+* consecutive symbols are one symbol period apart
+*
+*/
+void OFDMCodec::EncodeBatch(const uint8_t *input, double *output)
+{
+    size_t nPoints = m_Settings.nPoints;
+    size_t capacity = GetSymbolCapacity();
+    size_t symbolPeriod = GetSymbolPeriod();
+    size_t nBatch = m_fft.GetBatchSize();
+    // QAM Encode each symbol into its transform input
+    for(size_t k = 0; k < nBatch; k++)
+    {
+        PROFILE_SCOPE(&m_profiler, PROFILE_QAM_MODULATE);
+        m_qam.Modulate(&input[k*capacity], (double *) m_fft.batchIn[k*nPoints], capacity);
+    }
+    // Transform the whole batch
+    PROFILE_SCOPE(&m_profiler, PROFILE_IFFT);
+    m_fft.ComputeBatchTransform();
+    for(size_t k = 0; k < nBatch; k++)
+    {
+        double *symbol = &output[k*symbolPeriod];
+        if(m_spectralRotation)
+        {
+            // Transform is Nyquist modulated already
+            std::copy( (double *) m_fft.batchOut[k*nPoints], (double *) m_fft.batchOut[(k+1)*nPoints], &symbol[m_Settings.cyclicPrefixSize]);
+        }
+        else
+        {
+            // Run nyquist modulator while copying the transform into the symbol
+            m_NyquistModulator.Modulate(&m_fft.batchOut[k*nPoints], &symbol[m_Settings.cyclicPrefixSize]);
+        }
+        // Add cyclic prefix
+        AddCyclicPrefix(symbol, GetSymbolSamples(), m_Settings.cyclicPrefixSize);
+    }
+}
+
+
+/**
+* Sets up the codec to process nSymbols symbols per transform
+* execution. EncodeFrame then encodes full batches of symbols 
+* and DecodeBatch decodes up to nSymbols at a time.
+* 
+* @param nSymbols number of symbols in the batch
+*
+* @return 0 on success, else error number
+*
+*/
+int OFDMCodec::ConfigureBatch(size_t nSymbols)
+{
+    if(m_fft.ConfigureBatch(nSymbols) != 0)
+    {
+        return -1;
+    }
+    SaveWisdom();
+    return 0;
+}
+
+
+/**
+* Imports the wisdom file specified in the settings, if any,
+* before the transform plans are created. A missing file is
+* not an error, it is created once the plans have been measured.
+* 
+* @param settings settings of the codec being constructed
+*
+* @return planner effort for the transform plans
+*
+*/
+PlannerEffort OFDMCodec::LoadWisdom(const OFDMSettings &settings)
+{
+    if(!settings.wisdomFile.empty())
+    {
+        ofdmFFT::ImportWisdom(settings.wisdomFile);
+    }
+    return settings.plannerEffort;
+}
+
+
+/**
+* Exports the wisdom to the file specified in the settings
+* if planning has added to the wisdom since it was last loaded
+* or saved. Plans taken from the cache or created from imported
+* wisdom leave the file untouched.
+*
+*/
+void OFDMCodec::SaveWisdom()
+{
+    if(m_Settings.wisdomFile.empty())
+    {
+        return;
+    }
+    uint64_t generation = FFTPlanCache::GetWisdomGeneration();
+    if( (generation != m_wisdomGeneration) && (ofdmFFT::ExportWisdom(m_Settings.wisdomFile) == 0) )
+    {
+        m_wisdomGeneration = generation;
+    }
 }
 
 
@@ -62,16 +319,449 @@ ByteVec OFDMCodec::Decode(const DoubleVec &input, size_t nBytes)
 {
     // Create output vector
     ByteVec output(nBytes);
+    Decode(input.data(), input.size(), output.data(), nBytes);
+    return output;
+}
+
+
+/**
+* Decodes One OFDM Symbol into caller provided buffer.
+* This function does not allocate any memory.
+*
+* @param input pointer to the Rx signal samples
+*
+* @param inputSize number of samples in the Rx signal buffer
+*
+* @param output pointer to the destination of nBytes decoded bytes
+*
+* @param nBytes number of bytes encoded in the symbol
+*
+* @return 0 on success, else -1
+*
+*/
+int OFDMCodec::Decode(const double *input, size_t inputSize, uint8_t *output, size_t nBytes)
+{
+    auto start = m_monitor.Start();
+    PROFILE_SCOPE(&m_profiler, PROFILE_DECODE);
+    if(nBytes > GetSymbolCapacity())
+    {
+        return -1;
+    }
     // Time sync to first symbol start
-    size_t symbolStart = 0;
-    symbolStart = m_detector.FindSymbolStart(input, nBytes);
-    // Run Data thrgough nyquist demodulator
-    m_NyquistModulator.Demodulate(input, symbolStart);
-    // Compute FFT & Normalise
-    m_fft.ComputeTransform();
-    // Normalise FFT
-    m_fft.Normalise();
+    size_t symbolStart = m_detector.FindSymbolStart(input, inputSize, nBytes);
+    if(symbolStart == (size_t) -1)
+    {
+        return -1;
+    }
+    // Nyquist demodulate and compute FFT, the demodulator applies the normalisation
+    TransformSymbol(input, symbolStart);
     // Decode QAM encoded fft points and place in the destination buffer
-    m_qam.Demodulate( (DoubleVec &) m_fft.out, output, nBytes);
-    return output;
+    {
+        PROFILE_SCOPE(&m_profiler, PROFILE_QAM_DEMODULATE);
+        m_qam.Demodulate( (double *) m_fft.out, output, nBytes);
+    }
+    m_monitor.Record(MONITOR_DECODE, start, GetSymbolPeriod());
+    return 0;
+}
+
+
+/**
+* Decodes One OFDM Symbol into likelihood ratios of its bits,
+* for a decoder of an error correcting code behind the codec.
+* This function does not allocate any memory.
+*
+* @param input pointer to the Rx signal samples
+*
+* @param inputSize number of samples in the Rx signal buffer
+*
+* @param output pointer to the destination of 8*nBytes likelihood ratios,
+* bit i of byte n is held in output[n*8+i], positive ratios favour set bits
+*
+* @param nBytes number of bytes encoded in the symbol
+*
+* @param noiseVariance noise power per point, estimated from the symbol if not positive
+*
+* @return 0 on success, else -1
+*
+*/
+int OFDMCodec::DecodeSoft(const double *input, size_t inputSize, float *output, size_t nBytes, double noiseVariance)
+{
+    auto start = m_monitor.Start();
+    PROFILE_SCOPE(&m_profiler, PROFILE_DECODE);
+    if(nBytes > GetSymbolCapacity())
+    {
+        return -1;
+    }
+    // Time sync to first symbol start
+    size_t symbolStart = m_detector.FindSymbolStart(input, inputSize, nBytes);
+    if(symbolStart == (size_t) -1)
+    {
+        return -1;
+    }
+    TransformSymbol(input, symbolStart);
+    {
+        PROFILE_SCOPE(&m_profiler, PROFILE_QAM_DEMODULATE);
+        m_qam.DemodulateSoft( (double *) m_fft.out, output, nBytes, noiseVariance);
+    }
+    m_monitor.Record(MONITOR_DECODE, start, GetSymbolPeriod());
+    return 0;
+}
+
+
+/**
+* Prepares the transform input from the samples of one symbol.
+* Complex time series is Nyquist demodulated into the destination,
+* or copied if the spectrum is rotated, real time series is copied
+* into the real transform input.
+*
+* @param input pointer to the Rx signal samples
+*
+* @param symbolStart index of the first sample of the symbol, after the prefix
+*
+* @param dest pointer to the complex transform input
+*
+*/
+void OFDMCodec::DemodulateSymbol(const double *input, size_t symbolStart, fftw_complex *dest)
+{
+    if(m_Settings.transform == TRANSFORM_REAL)
+    {
+        std::copy(&input[symbolStart], &input[symbolStart + m_Settings.nPoints], m_fft.real);
+        return;
+    }
+    if(m_spectralRotation)
+    {
+        // Demodulator reads the rotated spectrum
+        std::copy(&input[symbolStart], &input[symbolStart + m_Settings.nPoints*2], (double *) dest);
+        return;
+    }
+    m_NyquistModulator.Demodulate(input, symbolStart, dest);
+}
+
+
+/**
+* Computes the transform of one symbol into the fft output.
+* Real time series and rotated spectra need no demodulation,
+* the transform reads them straight from the Rx signal, so the
+* samples are read once. Otherwise the samples are Nyquist 
+* demodulated into the transform input first.
+*
+* @param input pointer to the Rx signal samples
+*
+* @param symbolStart index of the first sample of the symbol, after the prefix
+*
+*/
+void OFDMCodec::TransformSymbol(const double *input, size_t symbolStart)
+{
+    PROFILE_SCOPE(&m_profiler, PROFILE_FFT);
+    if( (m_Settings.transform == TRANSFORM_REAL) || m_spectralRotation )
+    {
+        m_fft.ComputeTransform(&input[symbolStart]);
+        return;
+    }
+    m_NyquistModulator.Demodulate(input, symbolStart, m_fft.in);
+    m_fft.ComputeTransform();
+}
+
+
+/**
+* Decodes all symbols found in a capture, i.e. a frame. Every symbol 
+* is expected to carry GetSymbolCapacity() bytes. Symbol starts
+* are located first and the symbols are then transformed a batch
+* at a time, if the batch has been configured. The search starts
+* at the beginning of the buffer, the starts of the following 
+* symbols are tracked.
+*
+* @param input pointer to the Rx signal samples
+*
+* @param inputSize number of samples in the Rx signal buffer
+*
+* @param output pointer to the destination, capable of holding
+* maxSymbols * GetSymbolCapacity() bytes
+*
+* @param maxSymbols maximum number of symbols to be decoded
+*
+* @return number of decoded symbols
+*
+*/
+size_t OFDMCodec::DecodeBatch(const double *input, size_t inputSize, uint8_t *output, size_t maxSymbols)
+{
+    auto start = m_monitor.Start();
+    size_t nPoints = m_Settings.nPoints;
+    size_t capacity = GetSymbolCapacity();
+    size_t halfRange = (m_detector.GetSearchRange()-1) / 2;
+    // Without the batch decode a symbol at a time
+    size_t nBatch = std::max(m_fft.GetBatchSize(), (size_t) 1);
+    fftw_complex *transformIn = m_fft.GetBatchSize() ? m_fft.batchIn : m_fft.in;
+    fftw_complex *transformOut = m_fft.GetBatchSize() ? m_fft.batchOut : m_fft.out;
+
+    size_t nDecoded = 0;
+    m_detector.Unlock();
+    m_detector.SetSearchOffset(0);
+    while(nDecoded < maxSymbols)
+    {
+        // Locate symbols and demodulate them into the transform inputs
+        size_t nFound = 0;
+        while( (nFound < nBatch) && (nDecoded + nFound < maxSymbols) )
+        {
+            size_t symbolStart = 0;
+            int trackStatus = m_detector.IsLocked() ? m_detector.TrackSymbolStart(input, 0, inputSize, capacity, symbolStart) : -1;
+            if(trackStatus == 1)
+            {
+                break;
+            }
+            // Full search when not locked or the lock has been lost
+            if(trackStatus != 0)
+            {
+                size_t prefixStart = 0;
+                if(m_detector.StreamSearch(input, 0, inputSize, prefixStart) != 0)
+                {
+                    break;
+                }
+                size_t coarseStart = prefixStart + m_Settings.cyclicPrefixSize;
+                if(coarseStart + halfRange + GetSymbolSamples() > inputSize)
+                {
+                    break;
+                }
+                symbolStart = m_detector.FineSearch(input, coarseStart, capacity);
+                m_detector.Lock(symbolStart);
+            }
+            DemodulateSymbol(input, symbolStart, &transformIn[nFound*nPoints]);
+            m_detector.SetSearchOffset(symbolStart + GetSymbolSamples() - halfRange);
+            nFound++;
+        }
+        if(nFound == 0)
+        {
+            break;
+        }
+        // Compute FFT of all symbols, the demodulator applies the normalisation
+        {
+            PROFILE_SCOPE(&m_profiler, PROFILE_FFT);
+            if(m_fft.GetBatchSize())
+            {
+                m_fft.ComputeBatchTransform();
+            }
+            else
+            {
+                m_fft.ComputeTransform();
+            }
+        }
+        // Decode QAM encoded fft points of each symbol
+        for(size_t k = 0; k < nFound; k++)
+        {
+            PROFILE_SCOPE(&m_profiler, PROFILE_QAM_DEMODULATE);
+            m_qam.Demodulate( (double *) transformOut[k*nPoints], &output[(nDecoded+k)*capacity], capacity);
+        }
+        nDecoded += nFound;
+        // Ran out of symbols
+        if(nFound < nBatch)
+        {
+            break;
+        }
+    }
+    m_monitor.Record(MONITOR_DECODE, start, nDecoded*GetSymbolPeriod());
+    return nDecoded;
+}
+
+
+/**
+* Decodes a block of samples which is a part of a continuous stream.
+* Samples are appended to the internal ring buffer and every symbol
+* completed by this block is decoded and appended to the output.
+* Symbols split across blocks are decoded once the block
+* containing their end arrives. 
+*
+* @param input reference to the block of samples
+*
+* @param output reference to the byte vector decoded bytes are appended to
+*
+* @param nBytes number of bytes encoded in each symbol
+*
+* @return number of symbols decoded 
+*
+*/
+size_t OFDMCodec::DecodeStream(const DoubleVec &input, ByteVec &output, size_t nBytes)
+{
+    return DecodeStream(input.data(), input.size(), output, nBytes);
+}
+
+
+/**
+* Decodes a block of samples which is a part of a continuous stream.
+*
+* @param input pointer to the block of samples
+*
+* @param nSamples number of samples in the block
+*
+* @param output reference to the byte vector decoded bytes are appended to
+*
+* @param nBytes number of bytes encoded in each symbol
+*
+* @return number of symbols decoded 
+*
+*/
+size_t OFDMCodec::DecodeStream(const double *input, size_t nSamples, ByteVec &output, size_t nBytes)
+{
+    auto start = m_monitor.Start();
+    size_t nSymbols = 0;
+    size_t nPushed = 0;
+    while(true)
+    {
+        // Fill the buffer with as much of the block as fits
+        size_t nNew = m_ringBuffer.Push(&input[nPushed], nSamples - nPushed);
+        nPushed += nNew;
+        // Decode all completed symbols
+        size_t nDecoded = 0;
+        while(ProcessStream(output, nBytes))
+        {
+            nDecoded++;
+        }
+        nSymbols += nDecoded;
+        // Release samples which are not going to be needed
+        size_t retainOffset = m_detector.GetRetainOffset();
+        if(m_streamPrefixFound)
+        {
+            size_t coarseStart = m_streamPrefixStart + m_Settings.cyclicPrefixSize;
+            size_t halfRange = (m_detector.GetSearchRange()-1) / 2;
+            retainOffset = std::min(m_streamPrefixStart, (coarseStart > halfRange) ? coarseStart - halfRange : 0);
+        }
+        m_ringBuffer.Consume(retainOffset);
+        // Whole block has been processed
+        if(nPushed == nSamples)
+        {
+            break;
+        }
+        // Buffer is full and nothing can be released, drop the search in progress
+        if(nNew == 0 && nDecoded == 0 && m_ringBuffer.GetFree() == 0)
+        {
+            m_streamPrefixFound = false;
+            m_detector.Unlock();
+            m_detector.SetSearchOffset(m_ringBuffer.GetHead());
+            m_ringBuffer.Consume(m_ringBuffer.GetHead());
+        }
+    }
+    // The block must be processed before the next one arrives
+    m_monitor.Record(MONITOR_DECODE, start, nSamples);
+    return nSymbols;
+}
+
+
+/**
+* Runs the search on buffered samples and decodes
+* the next symbol if all of its samples are available.
+* After the first symbol the timing is tracked, the full
+* search only runs again when the lock is lost.
+*
+* @param output reference to the byte vector decoded bytes are appended to
+*
+* @param nBytes number of bytes encoded in the symbol
+*
+* @return true if a symbol has been decoded
+*
+*/
+bool OFDMCodec::ProcessStream(ByteVec &output, size_t nBytes)
+{
+    size_t tail = m_ringBuffer.GetTail();
+    size_t head = m_ringBuffer.GetHead();
+    const double *window = m_ringBuffer.Window(tail);
+    size_t symbolSize = GetSymbolSamples();
+    size_t halfRange = (m_detector.GetSearchRange()-1) / 2;
+    size_t symbolStart = 0;
+    // Track the timing of the previous symbol
+    int trackStatus = m_detector.IsLocked() ? m_detector.TrackSymbolStart(window, tail, head, nBytes, symbolStart) : -1;
+    if(trackStatus == 1)
+    {
+        return false;
+    }
+    // Not locked or the lock has been lost
+    if(trackStatus != 0)
+    {
+        // Coarse search on prefix
+        if(!m_streamPrefixFound)
+        {
+            m_streamPrefixFound = (m_detector.StreamSearch(window, tail, head, m_streamPrefixStart) == 0);
+            if(!m_streamPrefixFound)
+            {
+                return false;
+            }
+        }
+        // Wait until the whole fine search range is available
+        size_t coarseStart = m_streamPrefixStart + m_Settings.cyclicPrefixSize;
+        if(coarseStart + halfRange + symbolSize > head)
+        {
+            return false;
+        }
+        // Pilot tone search
+        symbolStart = m_detector.FineSearch(window, coarseStart - tail, nBytes) + tail;
+        m_detector.Lock(symbolStart);
+    }
+    // Nyquist demodulate and compute FFT, the demodulator applies the normalisation
+    TransformSymbol(window, symbolStart - tail);
+    // Decode QAM encoded fft points and append to the output
+    size_t outputSize = output.size();
+    output.resize(outputSize + nBytes);
+    {
+        PROFILE_SCOPE(&m_profiler, PROFILE_QAM_DEMODULATE);
+        m_qam.Demodulate( (double *) m_fft.out, &output[outputSize], nBytes);
+    }
+    // Resume the search just before the next prefix is expected
+    m_streamPrefixFound = false;
+    m_detector.SetSearchOffset(symbolStart + symbolSize - halfRange);
+    return true;
+}
+
+
+/**
+* Discards all buffered samples and the search in progress.
+* The next block is treated as the start of a new stream.
+*
+*/
+void OFDMCodec::ResetStream()
+{
+    m_ringBuffer.Reset();
+    m_streamPrefixFound = false;
+    m_streamPrefixStart = 0;
+    m_detector.Unlock();
+    m_detector.SetSearchOffset(0);
+}
+
+
+// Instrumentation Related Functions //
+
+
+/**
+* Copies the latency counters of the encoding and decoding stages,
+* safe to call while another thread encodes or decodes.
+* 
+* @param snapshot destination of the counters
+*
+* @return 0 on success, -1 if the library has been built without OFDMLIB_PROFILING
+*
+*/
+int OFDMCodec::GetProfile(ProfileSnapshot &snapshot) const
+{
+    m_profiler.GetSnapshot(snapshot);
+    return StageProfiler::IsCompiled() ? 0 : -1;
+}
+
+
+/**
+* Switches the recording of the stage latencies on or off,
+* it is on by default if compiled in.
+* 
+* @param enabled true to record the stages
+*
+*/
+void OFDMCodec::SetProfiling(bool enabled)
+{
+    m_profiler.SetEnabled(enabled);
+}
+
+
+/**
+* Clears the latency counters of all stages
+*
+*/
+void OFDMCodec::ResetProfile()
+{
+    m_profiler.Reset();
 }
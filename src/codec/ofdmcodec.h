@@ -20,6 +20,8 @@
 // Ofdmlib objects
 #include "detector.h" // this has fft & nyquist definitions as include header
 #include "qam-modulator.h"
+#include "ring-buffer.h"
+#include "realtime-monitor.h"
 #include "common.h"
 
 struct OFDMSettings
@@ -30,8 +32,14 @@ struct OFDMSettings
 	size_t pilotToneStep; // Pilot Tones
     double  pilotToneAmplitude; // Pilot Tones
     size_t guardInterval; // The time between the current and consecutive ofdm symbol
-    size_t QAMSize; // QAM Modulator 
+    size_t QAMSize; // QAM Modulator, bits per point: 2, 4, 6 or 8 for 4, 16, 64 and 256-QAM
     size_t cyclicPrefixSize; // Cyclic-Prefix
+    PlannerEffort plannerEffort = PLANNER_MEASURE; // FFT planning
+    std::string wisdomFile; // FFT wisdom loaded on construction and updated after measuring, unused if empty
+    TransformType transform = TRANSFORM_COMPLEX; // Nyquist modulated complex or real (Hermitian spectrum) time series
+    EqualiserType equaliser = EQUALISER_NONE; // One-tap equaliser driven by the pilot tones of each received symbol
+    bool spectralRotation = true; // Nyquist modulate even complex transforms by rotating the spectrum by nPoints/2
+    double sampleRate = 0.0; // Samples per second of the Tx/Rx signal, deadlines of Encode and Decode are monitored if positive
 };
 
 
@@ -49,12 +57,38 @@ public:
 
 	OFDMCodec(OFDMSettings settingsStruct) :
         m_Settings(settingsStruct),
-        m_fft(settingsStruct.nPoints, settingsStruct.type, settingsStruct.pilotToneStep),
+        m_wisdomGeneration(FFTPlanCache::GetWisdomGeneration()),
+        m_fft(settingsStruct.nPoints, settingsStruct.type, settingsStruct.pilotToneStep, LoadWisdom(settingsStruct), settingsStruct.transform),
         m_NyquistModulator(settingsStruct.nPoints, ( settingsStruct.type == +1 ) ?  m_fft.out : m_fft.in),
         m_detector(settingsStruct.nPoints, settingsStruct.cyclicPrefixSize, &m_fft, &m_NyquistModulator),
-        m_qam(settingsStruct.nPoints, settingsStruct.pilotToneStep,  settingsStruct.pilotToneAmplitude, settingsStruct.EnergyDispersalSeed, settingsStruct.QAMSize)
+        m_qam(settingsStruct.nPoints, settingsStruct.pilotToneStep,  settingsStruct.pilotToneAmplitude, settingsStruct.EnergyDispersalSeed, settingsStruct.QAMSize, settingsStruct.transform == TRANSFORM_REAL),
+        m_streamPrefixFound(false),
+        m_streamPrefixStart(0),
+        m_spectralRotation(settingsStruct.spectralRotation && (settingsStruct.transform == TRANSFORM_COMPLEX) && (settingsStruct.nPoints % 2 == 0))
     {
-
+        // Pilot tone locations depend on the QAM order
+        m_fft.SetBitsPerSymbol(settingsStruct.QAMSize);
+        m_qam.SetEqualiser(settingsStruct.equaliser);
+        // Fold the 1/N normalisation of the FFT into the demodulator
+        m_qam.SetInputScale(1.0 / (double) settingsStruct.nPoints);
+        m_detector.SetProfiler(&m_profiler);
+        // Tracking predicts the next symbol one period, guard interval included, ahead
+        m_detector.SetSymbolPeriod(GetSymbolPeriod());
+        // Multiplying by (-1)^n shifts the spectrum by nPoints/2, odd transforms
+        // can not be shifted by half a point and keep the Nyquist modulator
+        if(m_spectralRotation)
+        {
+            m_qam.SetRotation(settingsStruct.nPoints/2);
+        }
+        // Scratch space for the last, partially filled symbol of a frame
+        m_padBuffer.resize(m_qam.GetMaxEncodedBytes());
+        // Stream buffer holds the widest correlation peak search followed by
+        // a whole symbol and its fine search margin, twice over to leave room for new samples
+        m_ringBuffer.Configure(2 * (GetSymbolSamples() + 3*settingsStruct.cyclicPrefixSize + m_detector.GetSearchRange()));
+        // Each symbol must be encoded or decoded within its period on air
+        m_monitor.Configure(settingsStruct.sampleRate, GetSymbolPeriod());
+        // Keep measured plans for the next start
+        SaveWisdom();
 	}
 
     /**
@@ -69,18 +103,63 @@ public:
 
     // Encoding Related Functions //
     DoubleVec Encode(const ByteVec &input, size_t nBytes);
+    int Encode(const uint8_t *input, size_t nBytes, double *output, size_t outputSize);
+    DoubleVec EncodeFrame(const ByteVec &input, size_t nBytes);
+    size_t EncodeFrame(const ByteVec &input, size_t nBytes, DoubleVec &output);
     // Decode Related Functions //
     ByteVec Decode(const DoubleVec &input, size_t nBytes);
+    int Decode(const double *input, size_t inputSize, uint8_t *output, size_t nBytes);
+    int DecodeSoft(const double *input, size_t inputSize, float *output, size_t nBytes, double noiseVariance = 0.0);
+    size_t DecodeBatch(const double *input, size_t inputSize, uint8_t *output, size_t maxSymbols);
+    size_t DecodeStream(const DoubleVec &input, ByteVec &output, size_t nBytes);
+    size_t DecodeStream(const double *input, size_t nSamples, ByteVec &output, size_t nBytes);
+    void ResetStream();
+
+    // Batch Related Functions //
+    int ConfigureBatch(size_t nSymbols);
 
     const OFDMSettings & GetSettings() const;
+    size_t GetSymbolCapacity() const;
+    size_t GetSymbolSize() const;
+    size_t GetFrameSize(size_t nBytes) const;
+    size_t GetSymbolPeriod() const;
+
+    // Instrumentation Related Functions //
+    int GetProfile(ProfileSnapshot &snapshot) const;
+    void SetProfiling(bool enabled);
+    void ResetProfile();
+    RealTimeMonitor & GetMonitor();
+    const RealTimeMonitor & GetMonitor() const;
+    size_t GetAcquisitionCount() const;
 
 private:
+
+    static PlannerEffort LoadWisdom(const OFDMSettings &settings);
+    void SaveWisdom();
+    size_t GetSymbolSamples() const;
+    void DemodulateSymbol(const double *input, size_t symbolStart, fftw_complex *dest);
+    void TransformSymbol(const double *input, size_t symbolStart);
+    void EncodeSymbol(const uint8_t *input, size_t nBytes, double *symbol);
+    void EncodeBatch(const uint8_t *input, double *output);
+    bool ProcessStream(ByteVec &output, size_t nBytes);
+
     // ofdm related objects
     OFDMSettings m_Settings;
+    // Wisdom generation last loaded or saved by this codec
+    uint64_t m_wisdomGeneration;
 	ofdmFFT m_fft;
     NyquistModulator m_NyquistModulator;
     Detector m_detector;
     QamModulator m_qam;
+    // Zero padded copy of the frame's tail
+    ByteVec m_padBuffer;
+    // Streaming decoder state
+    RingBuffer m_ringBuffer;
+    bool m_streamPrefixFound;
+    size_t m_streamPrefixStart;
+    bool m_spectralRotation; /// Transforms of the rotated spectrum are Nyquist modulated
+    StageProfiler m_profiler; /// Latency of the encoding and decoding stages, see OFDMLIB_PROFILING
+    RealTimeMonitor m_monitor; /// Deadlines of Encode and Decode at the configured sample rate
 
 };
 
@@ -89,4 +168,76 @@ private:
      return m_Settings;
  }
 
+/**
+* @return maximum number of bytes encoded in one symbol
+*/
+ inline size_t OFDMCodec::GetSymbolCapacity() const
+ {
+     return m_qam.GetMaxEncodedBytes();
+ }
+
+/**
+* @return number of samples in one symbol including the cyclic prefix
+*/
+ inline size_t OFDMCodec::GetSymbolSize() const
+ {
+     return GetSymbolSamples() + m_Settings.cyclicPrefixSize;
+ }
+
+/**
+* @return number of samples in one symbol excluding the cyclic prefix
+*/
+ inline size_t OFDMCodec::GetSymbolSamples() const
+ {
+     return (m_Settings.transform == TRANSFORM_REAL) ? m_Settings.nPoints : m_Settings.nPoints*2;
+ }
+
+/**
+* @return number of samples between the starts of consecutive symbols,
+* the symbol size followed by the guard interval
+*/
+ inline size_t OFDMCodec::GetSymbolPeriod() const
+ {
+     return GetSymbolSize() + m_Settings.guardInterval;
+ }
+
+/**
+* @param nBytes number of bytes to be encoded in the frame
+*
+* @return number of samples required to hold the encoded frame,
+* each symbol followed by its guard interval
+*/
+ inline size_t OFDMCodec::GetFrameSize(size_t nBytes) const
+ {
+     size_t capacity = GetSymbolCapacity();
+     if(capacity == 0)
+     {
+         return 0;
+     }
+     // Round up to whole symbols
+     return ((nBytes + capacity - 1) / capacity) * GetSymbolPeriod();
+ }
+
+/**
+* @return deadline monitor of Encode and Decode calls
+*/
+ inline RealTimeMonitor & OFDMCodec::GetMonitor()
+ {
+     return m_monitor;
+ }
+
+ inline const RealTimeMonitor & OFDMCodec::GetMonitor() const
+ {
+     return m_monitor;
+ }
+
+/**
+* @return number of times the decoder has acquired the symbol timing
+* by the full search, symbols decoded while locked are not counted
+*/
+ inline size_t OFDMCodec::GetAcquisitionCount() const
+ {
+     return m_detector.GetAcquisitionCount();
+ }
+
 #endif
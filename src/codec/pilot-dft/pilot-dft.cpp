@@ -0,0 +1,209 @@
+/**
+* @file pilot-dft.cpp
+* @author Kamil Rog
+*
+* 
+*/
+
+
+#include "pilot-dft.h"
+#include <algorithm>
+#include <cmath>
+
+
+/**
+* Sets up the search for the transform and demodulator
+* 
+* @param fft pointer to the forward transform used to seed the search
+*
+* @param nyquist pointer to the demodulator writing into the transform input
+*
+* @param searchRange maximum number of candidate offsets
+*
+* @return 0 on success, else error number
+*
+*/
+int PilotDFT::Configure(ofdmFFT *fft, NyquistModulator *nyquist, size_t searchRange)
+{
+    pFFT = fft;
+    pNyquistModulator = nyquist;
+    m_nPoints = fft->GetSize();
+    m_real = (fft->GetTransformType() == TRANSFORM_REAL);
+    m_windowSize = m_real ? m_nPoints : m_nPoints*2;
+    // Reserve for every bin, changing pilots never allocates
+    m_pilots.reserve(m_nPoints);
+    m_rotation.reserve(m_nPoints*2);
+    m_bins.reserve(m_nPoints*2);
+    m_metrics.reserve(searchRange);
+    return 0;
+}
+
+
+/**
+* Sets the bins evaluated by the search
+* 
+* @param pilots indices of the pilot tone bins
+*
+* @return 0 on success, else error number
+*
+*/
+int PilotDFT::SetPilots(const std::vector<size_t> &pilots)
+{
+    m_pilots = pilots;
+    m_rotation.resize(pilots.size()*2);
+    m_bins.resize(pilots.size()*2);
+    for(size_t p = 0; p < pilots.size(); p++)
+    {
+        double angle = 2.0 * M_PI * (double) pilots[p] / (double) m_nPoints;
+        m_rotation[p*2] = cos(angle);
+        m_rotation[p*2+1] = sin(angle);
+    }
+    return 0;
+}
+
+
+/**
+* Computes the pilot bins of the window starting at offset 
+* with a full transform
+* 
+* @param input pointer to the Rx signal samples
+*
+* @param offset index of the first sample of the window
+*
+*/
+void PilotDFT::SeedChain(const double *input, size_t offset)
+{
+    if(m_real)
+    {
+        std::copy(&input[offset], &input[offset + m_windowSize], pFFT->real);
+    }
+    else
+    {
+        pNyquistModulator->Demodulate(input, offset);
+    }
+    pFFT->ComputeTransform();
+    for(size_t p = 0; p < m_pilots.size(); p++)
+    {
+        m_bins[p*2] = pFFT->out[m_pilots[p]][0];
+        m_bins[p*2+1] = pFFT->out[m_pilots[p]][1];
+    }
+}
+
+
+/**
+* Slides the pilot bins of the window starting at offset
+* to the next window of the chain
+* 
+* @param input pointer to the Rx signal samples
+*
+* @param offset index of the first sample of the current window
+*
+*/
+void PilotDFT::SlideChain(const double *input, size_t offset)
+{
+    double deltaReal = 0.0;
+    double deltaImag = 0.0;
+    if(m_real)
+    {
+        deltaReal = input[offset + m_nPoints] - input[offset];
+    }
+    else
+    {
+        // The entering point is N points later, the sign alternates every point
+        double sign = (m_nPoints % 2) ? -1.0 : 1.0;
+        deltaReal = sign * input[offset + m_windowSize] - input[offset];
+        deltaImag = sign * input[offset + m_windowSize + 1] - input[offset + 1];
+    }
+    // Window shifted by two samples flips the alternating sign
+    double flip = m_real ? 1.0 : -1.0;
+    for(size_t p = 0; p < m_pilots.size(); p++)
+    {
+        double real = m_bins[p*2] + deltaReal;
+        double imag = m_bins[p*2+1] + deltaImag;
+        m_bins[p*2] = flip * (real * m_rotation[p*2] - imag * m_rotation[p*2+1]);
+        m_bins[p*2+1] = flip * (real * m_rotation[p*2+1] + imag * m_rotation[p*2]);
+    }
+}
+
+
+/**
+* Computes the metric of the current window, the magnitude of the 
+* sum of the normalised imaginary parts of the pilot tones, or the 
+* sum of their magnitudes for real transforms
+* 
+* @return metric, zero for perfectly aligned symbol
+*
+*/
+double PilotDFT::ComputeMetric() const
+{
+    double sumOfImag = 0.0;
+    for(size_t p = 0; p < m_pilots.size(); p++)
+    {
+        sumOfImag += m_real ? std::abs(m_bins[p*2+1]) : m_bins[p*2+1];
+    }
+    return std::abs(sumOfImag) / m_nPoints;
+}
+
+
+/**
+* Finds the offset with the lowest metric in the range,
+* the first one is returned if several are equal.
+* 
+* @param input pointer to the Rx signal samples
+*
+* @param startIndex first candidate offset
+*
+* @param stopIndex one past the last candidate offset,
+* the whole window of the last candidate must be in the input
+*
+* @return offset of the lowest metric
+*
+*/
+size_t PilotDFT::Search(const double *input, size_t startIndex, size_t stopIndex)
+{
+    m_searchStart = startIndex;
+    m_metrics.assign(stopIndex > startIndex ? stopIndex - startIndex : 0, 0.0);
+    // Real windows move by one sample, complex by two per chain
+    size_t nChains = m_real ? 1 : 2;
+    for(size_t chain = 0; chain < nChains; chain++)
+    {
+        size_t offset = startIndex + chain;
+        if(offset >= stopIndex)
+        {
+            break;
+        }
+        SeedChain(input, offset);
+        while(true)
+        {
+            m_metrics[offset - startIndex] = ComputeMetric();
+            if(offset + nChains >= stopIndex)
+            {
+                break;
+            }
+            SlideChain(input, offset);
+            offset += nChains;
+        }
+    }
+    size_t lowestIndex = startIndex;
+    double min = 100000;
+    for(size_t i = 0; i < m_metrics.size(); i++)
+    {
+        if(m_metrics[i] < min)
+        {
+            min = m_metrics[i];
+            lowestIndex = startIndex + i;
+        }
+    }
+    return lowestIndex;
+}
+
+
+/**
+* @param index offset evaluated by the last search
+*
+* @return metric of the offset
+*/
+double PilotDFT::GetMetric(size_t index) const
+{
+    return m_metrics[index - m_searchStart];
+}
@@ -0,0 +1,86 @@
+/**
+* @file pilot-dft.h
+* @author Kamil Rog
+*
+* @section DESCRIPTION
+*
+* Pilot tone only DFT used by the fine symbol start search.
+* The spectrum of the first candidate offset is computed by a 
+* full transform, the pilot bins of the following offsets are
+* obtained by sliding the DFT one step at a time, which costs
+* a few operations per pilot tone instead of a full transform.
+*
+* Shifting the Nyquist demodulated window by two samples
+* shifts the complex series by one point and flips the sign of
+* the alternating +1/-1 factor, so for the window starting
+* at i0 + 2t, with v[r] = (-1)^r (x[i0+2r] + j x[i0+2r+1]):
+*
+* Y_t(k) = (-1)^t V_t(k)
+* V_{t+1}(k) = e^{j2pi k/N} (V_t(k) - v[t] + v[t+N])
+*
+* which, tracking Y directly with z(i) = x[i] + j x[i+1], is
+*
+* Y_{t+1}(k) = -e^{j2pi k/N} (Y_t(k) - z(i0+2t) + (-1)^N z(i0+2t+2N))
+*
+* Even and odd offsets form two independent chains. 
+* Real transforms slide by one sample with x in place of v.
+*/
+#ifndef PILOT_DFT_H
+#define PILOT_DFT_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+#include <fftw3.h>
+
+#include "ofdmfft.h"
+#include "nyquist-modulator.h"
+#include "common.h"
+
+
+/**
+ * @brief Sliding DFT of the pilot tone bins
+ * 
+ */
+class PilotDFT {
+
+public:
+
+	/**
+	* Constructor runs configure function.
+	* 
+	* @param fft pointer to the forward transform used to seed the search
+	* @param nyquist pointer to the demodulator writing into the transform input
+	* @param searchRange maximum number of candidate offsets
+	*
+	*/
+	PilotDFT(ofdmFFT *fft, NyquistModulator *nyquist, size_t searchRange)
+	{
+		Configure(fft, nyquist, searchRange);
+	}
+
+	int Configure(ofdmFFT *fft, NyquistModulator *nyquist, size_t searchRange);
+	int SetPilots(const std::vector<size_t> &pilots);
+	size_t Search(const double *input, size_t startIndex, size_t stopIndex);
+	double GetMetric(size_t index) const;
+
+private:
+
+	void SeedChain(const double *input, size_t offset);
+	void SlideChain(const double *input, size_t offset);
+	double ComputeMetric() const;
+
+	ofdmFFT *pFFT;
+	NyquistModulator *pNyquistModulator;
+	size_t m_nPoints = 0;
+	size_t m_windowSize = 0; /// Number of input samples transformed
+	bool m_real = false;
+	std::vector<size_t> m_pilots;
+	DoubleVec m_rotation; /// e^{j2pi k/N} of each pilot, interleaved real and imag
+	DoubleVec m_bins; /// Current unnormalised pilot bins Y, interleaved real and imag
+	DoubleVec m_metrics; /// Metric of each offset of the last search
+	size_t m_searchStart = 0;
+
+};
+
+#endif
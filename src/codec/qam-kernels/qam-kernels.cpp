@@ -0,0 +1,452 @@
+/**
+* @file qam-kernels.cpp
+* @author Kamil Rog
+*
+*
+*/
+
+
+#include "qam-kernels.h"
+#include <cmath>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define QAM_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+
+/**
+* Expands each bit into +1 if set and -1 if cleared,
+* starting from the least significant bit of each byte.
+*
+* @param input pointer to the first of nBytes bytes
+*
+* @param output pointer to the destination of 8*nBytes doubles
+*
+* @param nBytes number of bytes to map
+*
+*/
+static void MapBitsScalar(const uint8_t *input, double *output, size_t nBytes)
+{
+    for(size_t byteCounter = 0; byteCounter < nBytes; byteCounter++)
+    {
+        uint8_t dataByte = input[byteCounter];
+        for(size_t i = 0; i < 8; i++)
+        {
+            output[byteCounter*8+i] = (double) (((dataByte >> i) & 0x01) * 2) - 1.0;
+        }
+    }
+}
+
+
+/**
+* Sets each bit whose double is positive, the reverse of MapBits.
+*
+* @param input pointer to the first of 8*nBytes doubles
+*
+* @param output pointer to the destination of nBytes bytes
+*
+* @param nBytes number of bytes to pack
+*
+*/
+static void PackBitsScalar(const double *input, uint8_t *output, size_t nBytes)
+{
+    for(size_t byteCounter = 0; byteCounter < nBytes; byteCounter++)
+    {
+        uint8_t dataByte = 0;
+        for(size_t i = 0; i < 8; i++)
+        {
+            dataByte |= (uint8_t) ((input[byteCounter*8+i] > 0) << i);
+        }
+        output[byteCounter] = dataByte;
+    }
+}
+
+
+/**
+* Computes the max-log likelihood ratios of the Gray coded bits
+* of each axis value, positive ratios favour set bits. Ratios of 
+* value n are written to output[n*axisBits], the least significant
+* bit first.
+*
+* @param input pointer to the first of nValues axis values
+*
+* @param output pointer to the destination of nValues*axisBits ratios
+*
+* @param nValues number of axis values
+*
+* @param axisBits number of bits of each axis
+*
+* @param levelScale half of the distance between adjacent levels
+*
+* @param gain scale of the ratios, 4*levelScale over the noise variance
+*
+*/
+static void ComputeLLRScalar(const double *input, float *output, size_t nValues, size_t axisBits, double levelScale, double gain)
+{
+    for(size_t value = 0; value < nValues; value++)
+    {
+        double term = input[value];
+        double width = levelScale * (double) ((size_t) 1 << axisBits);
+        output[value*axisBits + axisBits - 1] = (float) (gain * term);
+        for(size_t bit = 1; bit < axisBits; bit++)
+        {
+            width *= 0.5;
+            term = width - std::abs(term);
+            output[value*axisBits + axisBits - 1 - bit] = (float) (gain * term);
+        }
+    }
+}
+
+
+#ifdef QAM_KERNELS_X86
+
+/**
+* SSE4.1 mapping of four bytes per iteration. A 32 bit word is
+* broadcast to both 64 bit lanes once and compared against the
+* masks of two bits at a time, shifting the next byte into place
+* after each byte. Lanes of set bits flip the sign of -1.
+*
+*/
+__attribute__((target("sse4.1")))
+static void MapBitsSSE4(const uint8_t *input, double *output, size_t nBytes)
+{
+    const __m128i mask01 = _mm_set_epi64x(0x02, 0x01);
+    const __m128i mask23 = _mm_set_epi64x(0x08, 0x04);
+    const __m128i mask45 = _mm_set_epi64x(0x20, 0x10);
+    const __m128i mask67 = _mm_set_epi64x(0x80, 0x40);
+    const __m128d minusOne = _mm_set1_pd(-1.0);
+    const __m128d signBit = _mm_set1_pd(-0.0);
+    size_t byteCounter = 0;
+    for(; byteCounter + 4 <= nBytes; byteCounter += 4)
+    {
+        uint32_t dataWord;
+        memcpy(&dataWord, input + byteCounter, sizeof(dataWord));
+        __m128i dataBytes = _mm_set1_epi64x(dataWord);
+        for(size_t i = 0; i < 4; i++)
+        {
+            __m128d set01 = _mm_castsi128_pd(_mm_cmpeq_epi64(_mm_and_si128(dataBytes, mask01), mask01));
+            __m128d set23 = _mm_castsi128_pd(_mm_cmpeq_epi64(_mm_and_si128(dataBytes, mask23), mask23));
+            __m128d set45 = _mm_castsi128_pd(_mm_cmpeq_epi64(_mm_and_si128(dataBytes, mask45), mask45));
+            __m128d set67 = _mm_castsi128_pd(_mm_cmpeq_epi64(_mm_and_si128(dataBytes, mask67), mask67));
+            double *points = output + (byteCounter + i)*8;
+            _mm_storeu_pd(points, _mm_xor_pd(minusOne, _mm_and_pd(set01, signBit)));
+            _mm_storeu_pd(points + 2, _mm_xor_pd(minusOne, _mm_and_pd(set23, signBit)));
+            _mm_storeu_pd(points + 4, _mm_xor_pd(minusOne, _mm_and_pd(set45, signBit)));
+            _mm_storeu_pd(points + 6, _mm_xor_pd(minusOne, _mm_and_pd(set67, signBit)));
+            dataBytes = _mm_srli_epi64(dataBytes, 8);
+        }
+    }
+    MapBitsScalar(input + byteCounter, output + byteCounter*8, nBytes - byteCounter);
+}
+
+
+/**
+* SSE packing of four bytes per iteration, movmskpd collects two
+* comparison results at a time and the bytes are stored as one word.
+*
+*/
+__attribute__((target("sse4.1")))
+static void PackBitsSSE4(const double *input, uint8_t *output, size_t nBytes)
+{
+    const __m128d zero = _mm_setzero_pd();
+    size_t byteCounter = 0;
+    for(; byteCounter + 4 <= nBytes; byteCounter += 4)
+    {
+        uint32_t dataWord = 0;
+        for(size_t i = 0; i < 4; i++)
+        {
+            const double *points = input + (byteCounter + i)*8;
+            int bits01 = _mm_movemask_pd(_mm_cmpgt_pd(_mm_loadu_pd(points), zero));
+            int bits23 = _mm_movemask_pd(_mm_cmpgt_pd(_mm_loadu_pd(points + 2), zero));
+            int bits45 = _mm_movemask_pd(_mm_cmpgt_pd(_mm_loadu_pd(points + 4), zero));
+            int bits67 = _mm_movemask_pd(_mm_cmpgt_pd(_mm_loadu_pd(points + 6), zero));
+            dataWord |= (uint32_t) (bits01 | (bits23 << 2) | (bits45 << 4) | (bits67 << 6)) << (i*8);
+        }
+        memcpy(output + byteCounter, &dataWord, sizeof(dataWord));
+    }
+    PackBitsScalar(input + byteCounter*8, output + byteCounter, nBytes - byteCounter);
+}
+
+
+/**
+* AVX2 mapping of four bytes per iteration. A 32 bit word is
+* broadcast once, variable shifts move bit i of the lowest byte
+* into the sign bit of lane i, so a set bit flips the sign of -1
+* without a comparison. The next byte is shifted into place after each byte.
+*
+*/
+__attribute__((target("avx2")))
+static void MapBitsAVX2(const uint8_t *input, double *output, size_t nBytes)
+{
+    const __m256i shiftLow = _mm256_set_epi64x(60, 61, 62, 63);
+    const __m256i shiftHigh = _mm256_set_epi64x(56, 57, 58, 59);
+    const __m256d minusOne = _mm256_set1_pd(-1.0);
+    const __m256d signBit = _mm256_set1_pd(-0.0);
+    size_t byteCounter = 0;
+    for(; byteCounter + 4 <= nBytes; byteCounter += 4)
+    {
+        uint32_t dataWord;
+        memcpy(&dataWord, input + byteCounter, sizeof(dataWord));
+        __m256i dataBytes = _mm256_set1_epi64x(dataWord);
+        for(size_t i = 0; i < 4; i++)
+        {
+            __m256d setLow = _mm256_castsi256_pd(_mm256_sllv_epi64(dataBytes, shiftLow));
+            __m256d setHigh = _mm256_castsi256_pd(_mm256_sllv_epi64(dataBytes, shiftHigh));
+            double *points = output + (byteCounter + i)*8;
+            _mm256_storeu_pd(points, _mm256_xor_pd(minusOne, _mm256_and_pd(setLow, signBit)));
+            _mm256_storeu_pd(points + 4, _mm256_xor_pd(minusOne, _mm256_and_pd(setHigh, signBit)));
+            dataBytes = _mm256_srli_epi64(dataBytes, 8);
+        }
+    }
+    MapBitsScalar(input + byteCounter, output + byteCounter*8, nBytes - byteCounter);
+}
+
+
+/**
+* AVX packing of four bytes per iteration, vmovmskpd collects four
+* comparison results at a time and the bytes are stored as one word.
+*
+*/
+__attribute__((target("avx2")))
+static void PackBitsAVX2(const double *input, uint8_t *output, size_t nBytes)
+{
+    const __m256d zero = _mm256_setzero_pd();
+    size_t byteCounter = 0;
+    for(; byteCounter + 4 <= nBytes; byteCounter += 4)
+    {
+        uint32_t dataWord = 0;
+        for(size_t i = 0; i < 4; i++)
+        {
+            const double *points = input + (byteCounter + i)*8;
+            int bitsLow = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(points), zero, _CMP_GT_OQ));
+            int bitsHigh = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(points + 4), zero, _CMP_GT_OQ));
+            dataWord |= (uint32_t) (bitsLow | (bitsHigh << 4)) << (i*8);
+        }
+        memcpy(output + byteCounter, &dataWord, sizeof(dataWord));
+    }
+    PackBitsScalar(input + byteCounter*8, output + byteCounter, nBytes - byteCounter);
+}
+
+
+/**
+* SSE likelihood ratios, terms of two values at a time.
+*
+*/
+__attribute__((target("sse4.1")))
+static void ComputeLLRSSE4(const double *input, float *output, size_t nValues, size_t axisBits, double levelScale, double gain)
+{
+    const __m128d signBit = _mm_set1_pd(-0.0);
+    const __m128d gainVector = _mm_set1_pd(gain);
+    alignas(16) float ratios[4];
+    size_t value = 0;
+    for(; value + 2 <= nValues; value += 2)
+    {
+        __m128d term = _mm_loadu_pd(input + value);
+        double width = levelScale * (double) ((size_t) 1 << axisBits);
+        for(size_t bit = 0; bit < axisBits; bit++)
+        {
+            if(bit)
+            {
+                width *= 0.5;
+                term = _mm_sub_pd(_mm_set1_pd(width), _mm_andnot_pd(signBit, term));
+            }
+            _mm_store_ps(ratios, _mm_cvtpd_ps(_mm_mul_pd(term, gainVector)));
+            output[value*axisBits + axisBits - 1 - bit] = ratios[0];
+            output[(value+1)*axisBits + axisBits - 1 - bit] = ratios[1];
+        }
+    }
+    ComputeLLRScalar(input + value, output + value*axisBits, nValues - value, axisBits, levelScale, gain);
+}
+
+
+/**
+* AVX2 likelihood ratios, terms of four values at a time. 
+* Ratios of 4-QAM are stored directly.
+*
+*/
+__attribute__((target("avx2")))
+static void ComputeLLRAVX2(const double *input, float *output, size_t nValues, size_t axisBits, double levelScale, double gain)
+{
+    const __m256d signBit = _mm256_set1_pd(-0.0);
+    const __m256d gainVector = _mm256_set1_pd(gain);
+    alignas(16) float ratios[4];
+    size_t value = 0;
+    if(axisBits == 1)
+    {
+        for(; value + 4 <= nValues; value += 4)
+        {
+            _mm_storeu_ps(output + value, _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_loadu_pd(input + value), gainVector)));
+        }
+    }
+    else
+    {
+        for(; value + 4 <= nValues; value += 4)
+        {
+            __m256d term = _mm256_loadu_pd(input + value);
+            double width = levelScale * (double) ((size_t) 1 << axisBits);
+            for(size_t bit = 0; bit < axisBits; bit++)
+            {
+                if(bit)
+                {
+                    width *= 0.5;
+                    term = _mm256_sub_pd(_mm256_set1_pd(width), _mm256_andnot_pd(signBit, term));
+                }
+                _mm_store_ps(ratios, _mm256_cvtpd_ps(_mm256_mul_pd(term, gainVector)));
+                for(size_t i = 0; i < 4; i++)
+                {
+                    output[(value+i)*axisBits + axisBits - 1 - bit] = ratios[i];
+                }
+            }
+        }
+    }
+    ComputeLLRScalar(input + value, output + value*axisBits, nValues - value, axisBits, levelScale, gain);
+}
+
+#endif
+
+
+/**
+* Maps each bit of nBytes bytes onto +/-1 using the selected kernel.
+* Bit i of byte n is written to output[n*8+i].
+*
+* @param input pointer to the first of nBytes bytes
+*
+* @param output pointer to the destination of 8*nBytes doubles
+*
+* @param nBytes number of bytes to map
+*
+*/
+void QamKernels::MapBits(const uint8_t *input, double *output, size_t nBytes)
+{
+    GetSelected().load(std::memory_order_relaxed)->map(input, output, nBytes);
+}
+
+
+/**
+* Packs the hard decisions of 8*nBytes doubles into bytes using
+* the selected kernel, positive values set the bits.
+*
+* @param input pointer to the first of 8*nBytes doubles
+*
+* @param output pointer to the destination of nBytes bytes
+*
+* @param nBytes number of bytes to pack
+*
+*/
+void QamKernels::PackBits(const double *input, uint8_t *output, size_t nBytes)
+{
+    GetSelected().load(std::memory_order_relaxed)->pack(input, output, nBytes);
+}
+
+
+/**
+* Computes the likelihood ratios of the bits of nValues axis values
+* using the selected kernel, see ComputeLLRScalar.
+*
+* @param input pointer to the first of nValues axis values
+*
+* @param output pointer to the destination of nValues*axisBits ratios
+*
+* @param nValues number of axis values
+*
+* @param axisBits number of bits of each axis
+*
+* @param levelScale half of the distance between adjacent levels
+*
+* @param gain scale of the ratios, 4*levelScale over the noise variance
+*
+*/
+void QamKernels::ComputeLLR(const double *input, float *output, size_t nValues, size_t axisBits, double levelScale, double gain)
+{
+    GetSelected().load(std::memory_order_relaxed)->llr(input, output, nValues, axisBits, levelScale, gain);
+}
+
+
+/**
+* @return instruction set of the kernels in use
+*/
+QamKernelSet QamKernels::GetKernelSet()
+{
+    return GetSelected().load(std::memory_order_relaxed)->kernelSet;
+}
+
+
+/**
+* Overrides the runtime selection, mainly for benchmarking
+* the kernels against each other.
+*
+* @param kernelSet instruction set of the kernels to use
+*
+* @return 0 on success, -1 if the CPU does not support it
+*
+*/
+int QamKernels::SetKernelSet(QamKernelSet kernelSet)
+{
+    if(!IsSupported(kernelSet))
+    {
+        return -1;
+    }
+    GetSelected().store(GetTable(kernelSet), std::memory_order_relaxed);
+    return 0;
+}
+
+
+/**
+* @param kernelSet instruction set of the kernels
+*
+* @return true if the CPU executing the process supports it
+*
+*/
+bool QamKernels::IsSupported(QamKernelSet kernelSet)
+{
+    switch(kernelSet)
+    {
+#ifdef QAM_KERNELS_X86
+        case QAM_KERNEL_AVX2:   return __builtin_cpu_supports("avx2");
+        case QAM_KERNEL_SSE4:   return __builtin_cpu_supports("sse4.1");
+#endif
+        case QAM_KERNEL_SCALAR: return true;
+        default:                return false;
+    }
+}
+
+
+/**
+* @param kernelSet instruction set of the kernels
+*
+* @return table of the kernels, scalar if not compiled in
+*
+*/
+const QamKernels::KernelTable *QamKernels::GetTable(QamKernelSet kernelSet)
+{
+    static const KernelTable scalar = { QAM_KERNEL_SCALAR, MapBitsScalar, PackBitsScalar, ComputeLLRScalar };
+#ifdef QAM_KERNELS_X86
+    static const KernelTable sse4 = { QAM_KERNEL_SSE4, MapBitsSSE4, PackBitsSSE4, ComputeLLRSSE4 };
+    static const KernelTable avx2 = { QAM_KERNEL_AVX2, MapBitsAVX2, PackBitsAVX2, ComputeLLRAVX2 };
+    switch(kernelSet)
+    {
+        case QAM_KERNEL_AVX2:   return &avx2;
+        case QAM_KERNEL_SSE4:   return &sse4;
+        default:                break;
+    }
+#endif
+    return &scalar;
+}
+
+
+/**
+* Kernels in use, the widest supported set is selected on first use.
+*
+* @return reference to the selected kernel table
+*
+*/
+std::atomic<const QamKernels::KernelTable *> & QamKernels::GetSelected()
+{
+    static std::atomic<const KernelTable *> selected(
+        IsSupported(QAM_KERNEL_AVX2) ? GetTable(QAM_KERNEL_AVX2) :
+        IsSupported(QAM_KERNEL_SSE4) ? GetTable(QAM_KERNEL_SSE4) :
+        GetTable(QAM_KERNEL_SCALAR));
+    return selected;
+}
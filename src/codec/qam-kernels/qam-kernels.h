@@ -0,0 +1,78 @@
+/**
+* @file qam-kernels.h
+* @author Kamil Rog
+*
+* @section DESCRIPTION
+*
+* Vectorised 4-QAM bit mapping kernels. Every bit of a 4-QAM
+* byte becomes one +/-1 component of a constellation point, so
+* mapping expands each byte into 8 doubles and demapping packs
+* the signs of 8 doubles back into a byte. The SSE4.1 kernel
+* compares broadcast bytes against bit masks, the AVX2 kernel
+* shifts each bit into the sign bit of its lane with per-lane
+* variable shifts. Both pack signs with movemask, the scalar
+* kernel works on each bit.
+* The widest kernel supported by the CPU is chosen at runtime.
+*
+* Soft demapping computes max-log likelihood ratios of the Gray
+* coded bits of each axis. The ratio of the most significant bit
+* is proportional to the received value y, the ratio of each next
+* bit to A_k - |t_(k-1)|, where t_(k-1) is the term of the previous
+* bit and A_k halves from half of the axis width with every bit.
+*/
+#ifndef QAM_KERNELS_H
+#define QAM_KERNELS_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <atomic>
+
+
+/**
+ * @brief Instruction set used by the kernels
+ *
+ */
+enum QamKernelSet {
+	QAM_KERNEL_SCALAR,
+	QAM_KERNEL_SSE4,
+	QAM_KERNEL_AVX2
+};
+
+
+/**
+ * @brief Runtime dispatched 4-QAM mapping and demapping kernels
+ *
+ */
+class QamKernels {
+
+public:
+
+	static void MapBits(const uint8_t *input, double *output, size_t nBytes);
+	static void PackBits(const double *input, uint8_t *output, size_t nBytes);
+	static void ComputeLLR(const double *input, float *output, size_t nValues, size_t axisBits, double levelScale, double gain);
+	static QamKernelSet GetKernelSet();
+	static int SetKernelSet(QamKernelSet kernelSet);
+	static bool IsSupported(QamKernelSet kernelSet);
+
+private:
+
+	using MapFunction = void (*)(const uint8_t *, double *, size_t);
+	using PackFunction = void (*)(const double *, uint8_t *, size_t);
+	using LLRFunction = void (*)(const double *, float *, size_t, size_t, double, double);
+
+	/**
+	 * @brief Kernels of one instruction set
+	 */
+	struct KernelTable {
+		QamKernelSet kernelSet;
+		MapFunction map;
+		PackFunction pack;
+		LLRFunction llr;
+	};
+
+	static const KernelTable *GetTable(QamKernelSet kernelSet);
+	static std::atomic<const KernelTable *> & GetSelected();
+
+};
+
+#endif
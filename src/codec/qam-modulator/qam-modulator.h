@@ -4,11 +4,34 @@
 *
 * @section DESCRIPTION
 *
-* 4-QAM Encoder/Decoder
+* QAM Encoder/Decoder
+*
+* 4-QAM maps bit pairs directly onto +/-1. Higher orders, 16, 64 
+* and 256-QAM, split the bits of each point between the real and 
+* imaginary axis and map them through Gray coded lookup tables 
+* of amplitude levels. Levels are scaled so that the average 
+* energy of a point equals the energy of a 4-QAM point. Hard 
+* decisions slice each axis to the nearest level. 4-QAM bits
+* are expanded into a contiguous buffer of points by the
+* vectorised kernels, which is then scattered onto the layout.
+*
+* Soft demapping writes the max-log likelihood ratio of every bit
+* instead of a hard decision, for decoders of error correcting
+* codes. Ratios are scaled by the noise variance per point, which 
+* is estimated from the distance of the points to the nearest 
+* constellation points unless the caller provides it.
+*
+* With an equaliser selected the channel is estimated from the 
+* pilot tones of each received symbol and every data point is 
+* multiplied by its equaliser coefficient as it is gathered, in
+* the same pass which feeds the demapping.
+*
+* The demodulator input may be scaled, e.g. an unnormalised FFT
+* output, the scale is applied while gathering the points or 
+* folded into the pilot tone division of the channel estimator.
 *
 * TODO: Breaking the encoding and decoding process into two loops for +ve and -ve
         freq respectivley is going to speed up processing.
-* TODO: Recursive encoding & decoding could be faster and could allow for multiple QAM schemes 
 */
 #ifndef QAM_MODULATOR_H
 #define QAM_MODULATOR_H
@@ -16,13 +39,19 @@
 #include <iostream>
 #include <bits/stdc++.h>
 #include "common.h"
+#include "energy-dispersal.h"
+#include "subcarrier-layout.h"
+#include "qam-kernels.h"
+#include "channel-estimator.h"
 #include <stdio.h>
 #include <string.h>
 
-#define BITS_IN_BYTE 8
+#define QAM_MAX_BITS_PER_SYMBOL 8
+#define QAM_MIN_NOISE_VARIANCE 1e-6 // Bounds the likelihood ratios of noiseless points
 
 /**
- * @brief 4-QAM modulator object,
+ * @brief QAM modulator object, QAM is the number of bits
+ * per point, 2, 4, 6 or 8 for 4, 16, 64 and 256-QAM
  *
  * 
  */
@@ -30,14 +59,20 @@ class QamModulator {
 
 public: 
 
-	QamModulator(size_t fftPoints, size_t pilotToneStep, double pilotToneAmplitude, size_t energyDispersalSeed, size_t QAM) :
+	QamModulator(size_t fftPoints, size_t pilotToneStep, double pilotToneAmplitude, size_t energyDispersalSeed, size_t QAM, bool hermitian = false) :
         m_nFFT(fftPoints),
         m_pilotToneStep(pilotToneStep),
         m_pilotToneAmplitude(pilotToneAmplitude),
         m_EnergyDispersalSeed(energyDispersalSeed),
-        m_BitsPerSymbol(QAM)
+        m_BitsPerSymbol(QAM),
+        m_hermitian(hermitian),
+        m_layout(fftPoints, pilotToneStep, hermitian),
+        m_energyDispersal(energyDispersalSeed, GetMaxEncodedBytes()),
+        m_scrambled(GetMaxEncodedBytes()),
+        m_points(m_layout.GetMaxDataPoints() * 2),
+        m_channelEstimator(fftPoints, pilotToneAmplitude, EQUALISER_NONE)
     {
-
+        ConfigureConstellation();
 	}
 
     /**
@@ -49,28 +84,60 @@ public:
 
 	} 
     void Modulate(const ByteVec &input, DoubleVec &output, size_t nBytes);
+    void Modulate(const uint8_t *input, double *output, size_t nBytes);
     void Demodulate(const DoubleVec &input, ByteVec &output, size_t nBytes); 
+    void Demodulate(const double *input, uint8_t *output, size_t nBytes); 
+    void DemodulateSoft(const double *input, float *output, size_t nBytes, double noiseVariance = 0.0);
+    double EstimateNoiseVariance(const double *input, size_t nBytes);
+    int SetEqualiser(EqualiserType equaliser);
+    int SetInputScale(double scale);
+    int SetRotation(size_t rotation);
+    const ChannelEstimator &GetChannelEstimator() const;
+    size_t GetMaxEncodedBytes() const;
+    size_t GetDataPoints(size_t nBytes) const;
+    static bool IsSupported(size_t bitsPerSymbol);
 
 private:
 
+    void ConfigureConstellation();
+    void ModulateLUT(const size_t *dataIndices, double *output, size_t nBytes) const;
+    void DemodulateLUT(const double *points, uint8_t *output, size_t nBytes) const;
+    bool GatherPoints(const double *input, size_t nDataPoints);
+    double GetDecisionError(size_t nDataPoints) const;
+    uint32_t SliceAxis(double value) const;
+    size_t SliceLevel(double value) const;
+
     size_t m_nFFT;
     size_t m_pilotToneStep;
     double m_pilotToneAmplitude;
     size_t m_EnergyDispersalSeed;
     size_t m_BitsPerSymbol;
+    bool m_hermitian; /// Map onto the positive half of the spectrum of a real transform
+    SubcarrierLayout m_layout;
+    EnergyDispersal m_energyDispersal;
+    ByteVec m_scrambled; /// Scrambled data bytes of the symbol being modulated
+    DoubleVec m_points; /// Contiguous data points of the symbol, interleaved real and imag pairs
+    ChannelEstimator m_channelEstimator;
+    double m_inputScale = 1.0; /// Scale of the demodulator input, applied while gathering the points
+    // Constellation, 4-QAM is two levels of unit amplitude
+    size_t m_axisBits = 1; /// Bits mapped onto each axis
+    size_t m_nLevels = 2; /// Amplitude levels of each axis
+    double m_levelScale = 1.0; /// Half of the distance between adjacent levels
+    DoubleVec m_levels; /// Amplitude of each Gray coded group of axis bits
+    ByteVec m_grayCode; /// Axis bits of each level, from the most negative
 
 };
 
 
 /**
-* 4-QAM modulator function.
-* Each fft point is capable of encoding 2bits.
-* Firstly energy dispersal is performed of each byte,
-* then a byte is encoded and placed into the ifft buffer.
-* This is acheived by macro which performs logical AND operation
-* on the data byte and mask which is subsequently shifted.
-* In addition a counter is used to insert pilot tone at appropriate
-* locations specified by the object parameters.    
+* QAM modulator function.
+* Each 4-QAM fft point is capable of encoding 2bits,
+* higher orders are mapped through the lookup tables.
+* Firstly energy dispersal is performed on the bytes,
+* then each byte is encoded and placed into the ifft buffer.
+* Bit pairs of the byte are scattered to the data points of the 
+* subcarrier layout and pilot tones are inserted at the pilot 
+* points, the layout is computed once for each number of bytes.
 * 
 * @param input reference to input data array to be encoded
 *
@@ -79,93 +146,70 @@ private:
 */
 inline void QamModulator::Modulate(const ByteVec &input, DoubleVec &output, size_t nBytes) 
 {
-    // Compute avaiable points for ifft
-    // This depends on the size of the ifft and pilot tone step
-    size_t nAvaiableifftPoints = (m_nFFT - (int)(m_nFFT/m_pilotToneStep));
-    // Compute the equivelent of avaiable data bytes per symbol
-    size_t nMaxEncodedBytes = (int)((nAvaiableifftPoints *  m_BitsPerSymbol)  / BITS_IN_BYTE);
+    Modulate(input.data(), output.data(), nBytes);
+}
 
+
+/**
+* QAM modulator function operating on raw buffers.
+* 
+* @param input pointer to the first of nBytes data bytes to be encoded
+*
+* @param output pointer to the ifft input, interleaved real and imag pairs 
+*
+* @param nBytes number of bytes encoded in the symbol
+*
+*/
+inline void QamModulator::Modulate(const uint8_t *input, double *output, size_t nBytes) 
+{
     // Check if the the number of bytes expected be demodulated is within one symbol
-    if(nMaxEncodedBytes < nBytes)
+    if(GetMaxEncodedBytes() < nBytes)
     {
         return;
     }
 
-    // Compute frequency coefficient index used
-    // Assume spectrum is centred symmetrically around DC and depends on nBytes
-    size_t startIndex = (int) ((m_nFFT*2) - (m_nFFT*2) / m_pilotToneStep / 2 - nBytes * 4 / 2);
-    startIndex = (int) startIndex / 2;
-
-    // Start insertion with negative frequencies
-    size_t ifftPointCounter = startIndex;
-    size_t pilotCounter =  (int) m_pilotToneStep / 2 ; // divide this by to when starting with -ve frequencies
+    m_layout.Update(GetDataPoints(nBytes));
+    const size_t *dataIndices = m_layout.GetDataIndices().data();
+    const std::vector<size_t> &pilotIndices = m_layout.GetPilotIndices();
 
-    // Set pseudo-random number generator
-    srand(m_EnergyDispersalSeed);
+    if(m_hermitian)
+    {
+        // The inverse real transform overwrites its input, set every point
+        std::fill(output, output + (m_nFFT/2 + 1)*2, 0.0);
+    }
 
-    uint8_t dataByte = 0;
-    uint8_t bitMask = 0x01;
+    // Perform energy dispersal of the whole symbol
+    m_energyDispersal.Apply(input, m_scrambled.data(), nBytes);
 
-    size_t insertionCounter = 0;
-    size_t byteCounter = 0;
-    while(byteCounter < nBytes)
+    if(m_BitsPerSymbol != 2)
+    {
+        ModulateLUT(dataIndices, output, nBytes);
+    }
+    else
     {
-        // Perform energy dispersal by xor-ing the data byte
-        dataByte = input[byteCounter] ^ rand() % 255;
-        // Reset bit mask
-        bitMask = 0x01;
-        // Reset fft point insertion counter 
-        insertionCounter = 0;
-        // While byte is being encoded
-        while(insertionCounter < 4)
+        // 4-QAM, each point encodes 2 bits, bit set maps to +1, bit cleared to -1
+        QamKernels::MapBits(m_scrambled.data(), m_points.data(), nBytes);
+        size_t nDataPoints = nBytes * 4;
+        for(size_t point = 0; point < nDataPoints; point++)
         {
-            // If pilot tone counter counted down
-            if(pilotCounter == 0)
-            {
-                // Reset counter
-                pilotCounter =  m_pilotToneStep;
-                // Insert Pilot Tone         
-                output[(ifftPointCounter*2)] = m_pilotToneAmplitude;
-                output[(ifftPointCounter*2)+1] = 0;
-
-            }
-            // Insert QAM Encoded point
-            else
-            {
-                // Set IFFT point to to appropriate value depending on the bit value
-                ((bitMask & dataByte) > 0 ) ?  output[(ifftPointCounter*2)] = 1.0 : output[(ifftPointCounter*2)] = -1.0;
-                // move bit in the mask by 1 to the left
-                bitMask <<= 1;
-                // Set IFFT point to to appropriate value depending on the bit value
-                ((bitMask & dataByte) > 0 ) ?  output[(ifftPointCounter*2)+1] = 1.0 : output[(ifftPointCounter*2)+1] = -1.0;
-                // move bit in the mask by 1 to the left
-                bitMask <<= 1;
-                // Indicate 2 bits have been inserted
-                insertionCounter++;
-                // Decrement pilot tone counter
-                pilotCounter--;               
-            }
-            // Increment ifft point counter to indicate complex point has been used
-            ifftPointCounter++;
-            // Check if the counter exceeds the total number of points
-            if(ifftPointCounter == m_nFFT)
-            {
-                // wrap to positive frequencies
-                ifftPointCounter = 0;
-            }
+            output[dataIndices[point]*2] = m_points[point*2];
+            output[dataIndices[point]*2+1] = m_points[point*2+1];
         }
-        // One full byte has been encoded
-        // Move to the next one
-        byteCounter++;
-        
+    }
+    // Insert Pilot Tones
+    for(size_t pilot : pilotIndices)
+    {
+        output[pilot*2] = m_pilotToneAmplitude;
+        output[pilot*2+1] = 0;
     }
 }
 
 
 /**
-* 4-QAM demodulator function.
-* Demodulator steps through the fft output and setting 
-* bits of each expected byte omitting pilot tones. The
+* QAM demodulator function.
+* Demodulator gathers the data points of the subcarrier layout
+* from the fft output, equalising them if an equaliser is set,
+* and sets bits of each expected byte. The
 * bit setting is achieved through logixal OR operation.
 * This is a simplistic hard decision algorithm, if the
 * value of the fft component exceeding 0 is equivelent
@@ -180,87 +224,437 @@ inline void QamModulator::Modulate(const ByteVec &input, DoubleVec &output, size
 */
 inline void QamModulator::Demodulate(const DoubleVec &input, ByteVec &output, size_t nBytes)
 {
-    size_t nAvaiableifftPoints = (m_nFFT - (int)(m_nFFT/m_pilotToneStep));
-    size_t nMaxEncodedBytes = (int)((nAvaiableifftPoints *  m_BitsPerSymbol)  / BITS_IN_BYTE);
+    Demodulate(input.data(), output.data(), nBytes);
+}
 
+
+/**
+* QAM demodulator function operating on raw buffers.
+* 
+* @param input pointer to the fft output, interleaved real and imag pairs
+*
+* @param output pointer to the destination of nBytes decoded bytes
+*
+* @param nBytes The expected number of bytes to be decoded from the symbol
+*
+*/
+inline void QamModulator::Demodulate(const double *input, uint8_t *output, size_t nBytes)
+{
     // Check if the the number of bytes expected be demodulated is within one symbol
-    if(nMaxEncodedBytes < nBytes)
+    if(GetMaxEncodedBytes() < nBytes)
     {
         return;
     }
 
-    // Compute frequency coefficient index used
-    // Assume spectrum is centred symmetrically around DC and depends on nBytes
-    size_t startIndex = (int) ((m_nFFT*2) - (m_nFFT*2) / m_pilotToneStep / 2 - nBytes * 4 / 2);
-    startIndex = (int) startIndex / 2;
+    size_t nDataPoints = GetDataPoints(nBytes);
+    m_layout.Update(nDataPoints);
+    GatherPoints(input, nDataPoints);
 
-    // Start insertion with negative frequencies
-    size_t fftPointCounter = startIndex;
-    size_t pilotCounter =  (int) m_pilotToneStep / 2 ; // divide this by two when starting with -ve frequencies
+    if(m_BitsPerSymbol != 2)
+    {
+        DemodulateLUT(m_points.data(), output, nBytes);
+    }
+    else
+    {
+        // 4-QAM, each point encodes 2 bits
+        // Hard decision, positive value is equivalent to bit being set
+        QamKernels::PackBits(m_points.data(), output, nBytes);
+    }
+    // Recover original data by xor-ing with the scrambling sequence
+    m_energyDispersal.Apply(output, output, nBytes);
+}
 
-    // Set pseudo-random number generator
-    srand(m_EnergyDispersalSeed);
-    uint8_t bitMask = 0x01;
 
-    size_t insertionCounter = 0;
-    // For each byte 
-    for(size_t byteCounter = 0; byteCounter < nBytes; byteCounter++)
+/**
+* Soft decision QAM demodulator, writes the max-log likelihood
+* ratio of each bit of nBytes bytes. Bit i of byte n is held in 
+* output[n*8+i], positive ratios favour set bits. The magnitude 
+* grows with the distance from the decision boundary over the 
+* noise variance. Data points are gathered from the layout and
+* the ratios of each axis are computed by the vectorised kernel.
+* Ratios of equalised points are scaled by the channel power of
+* their carrier, the noise variance is then the noise before
+* equalisation, estimated from the pilot tones.
+* 
+* @param input pointer to the fft output, interleaved real and imag pairs
+*
+* @param output pointer to the destination of 8*nBytes likelihood ratios
+*
+* @param nBytes The expected number of bytes to be decoded from the symbol
+*
+* @param noiseVariance noise power per point, estimated from the symbol if not positive
+*
+*/
+inline void QamModulator::DemodulateSoft(const double *input, float *output, size_t nBytes, double noiseVariance)
+{
+    // Check if the the number of bytes expected be demodulated is within one symbol
+    if(GetMaxEncodedBytes() < nBytes)
+    {
+        return;
+    }
+    size_t nDataPoints = GetDataPoints(nBytes);
+    m_layout.Update(nDataPoints);
+    bool equalised = GatherPoints(input, nDataPoints);
+    if(noiseVariance <= 0.0)
     {
-        // Reset byte
-        output[byteCounter] = 0;
-        // Reset fft input pointer
-        insertionCounter = 0;
-        // Reset bit mask
-        bitMask = 0x01;
-        // Process 4 FFT points i.e 8 bits
-        while(insertionCounter < 4)
+        noiseVariance = equalised ? m_channelEstimator.GetNoiseVariance() : GetDecisionError(nDataPoints);
+    }
+    noiseVariance = std::max(noiseVariance, QAM_MIN_NOISE_VARIANCE);
+
+    // Max-log ratio of the nearest levels is 4 * scale * distance / variance
+    double gain = 4.0 * m_levelScale / noiseVariance;
+    size_t nBits = nBytes * BITS_IN_BYTE;
+    size_t nFullPoints = nBits / m_BitsPerSymbol;
+    QamKernels::ComputeLLR(m_points.data(), output, nFullPoints*2, m_axisBits, m_levelScale, gain);
+    // Ratios of the bits of the last point which are part of the data
+    if(nFullPoints < nDataPoints)
+    {
+        float ratios[QAM_MAX_BITS_PER_SYMBOL];
+        QamKernels::ComputeLLR(&m_points[nFullPoints*2], ratios, 2, m_axisBits, m_levelScale, gain);
+        std::copy(ratios, ratios + (nBits - nFullPoints*m_BitsPerSymbol), &output[nFullPoints*m_BitsPerSymbol]);
+    }
+    // Equalised points of weak carriers hold amplified noise
+    if(equalised)
+    {
+        const double *weights = m_channelEstimator.GetWeights().data();
+        for(size_t point = 0, bit = 0; bit < nBits; point++)
         {
-            // If pilot tone counter counted down
-            // This point is pilot tone
-            if(pilotCounter == 0)
-            {
-                // Reset Counter
-                // No need to process this in any way
-                pilotCounter = m_pilotToneStep;
-            }
-            // This point is not pilot tone
-            // Decode QAM encoded complex point
-            else
+            float weight = (float) weights[point];
+            size_t pointEnd = std::min(bit + m_BitsPerSymbol, nBits);
+            for(; bit < pointEnd; bit++)
             {
-                // Real component hard decision decoding
-                // If Real value is greater than 0
-                if( (input[fftPointCounter*2] > 0 ) )
-                {
-                    // Set the bit by bitwise OR operation
-                    output[byteCounter] |= bitMask;
-                }
-                // Shift bit in the mask by 1 to the left
-                bitMask <<= 1;
-                // Imag component hard decision decoding
-                // If Imag value is greater than 0
-                if( (input[fftPointCounter*2+1] > 0 ) )
-                {
-                    // Set the bit by bitwise OR operation
-                    output[byteCounter] |= bitMask;
-                }
-                // Shift bit in the mask by 1 to the left
-                bitMask <<= 1;
-                // 1/4 (2bits) of a byte has been processed
-                // Update counters
-                insertionCounter++;
-                pilotCounter--;
-            }
-            // Increment fft point counter
-            fftPointCounter++;
-            // Check if fft exceeds the limit of points
-            if(fftPointCounter == m_nFFT)
-            {
-                // Roll back to positive frequencies
-                fftPointCounter = 0;
+                output[bit] *= weight;
             }
         }
-        // Recover original data by xor-ing input byte with random value
-        output[byteCounter] ^= rand() % 255;
     }
+    // Scrambled bits are inverted, flip the sign of their ratios
+    m_energyDispersal.ApplySoft(output, nBytes);
+}
+
+
+/**
+* Estimates the noise power per point of the symbol. Equalised
+* symbols use the estimate of the channel estimator, otherwise the
+* distance of each data point to the nearest constellation point.
+* Decisions are wrong more often at low signal to noise ratios,
+* which biases the latter estimate low.
+* 
+* @param input pointer to the fft output, interleaved real and imag pairs
+*
+* @param nBytes number of bytes encoded in the symbol
+*
+* @return noise variance per point
+*
+*/
+inline double QamModulator::EstimateNoiseVariance(const double *input, size_t nBytes)
+{
+    if( (GetMaxEncodedBytes() < nBytes) || (nBytes == 0) )
+    {
+        return 0.0;
+    }
+    size_t nDataPoints = GetDataPoints(nBytes);
+    m_layout.Update(nDataPoints);
+    if(GatherPoints(input, nDataPoints))
+    {
+        return m_channelEstimator.GetNoiseVariance();
+    }
+    return GetDecisionError(nDataPoints);
+}
+
+
+/**
+* Selects the equaliser applied to the received data points
+* 
+* @param equaliser kind of the equaliser, EQUALISER_NONE disables it
+*
+* @return 0 on success, else error number
+*
+*/
+inline int QamModulator::SetEqualiser(EqualiserType equaliser)
+{
+    return m_channelEstimator.Configure(m_nFFT, m_pilotToneAmplitude, equaliser);
+}
+
+
+/**
+* Sets the scale of the demodulator input, so the demodulator can
+* be fed with an unnormalised FFT output scaled by 1/nPoints.
+* 
+* @param scale positive factor of every input point
+*
+* @return 0 on success, else error number
+*
+*/
+inline int QamModulator::SetInputScale(double scale)
+{
+    if(scale <= 0.0)
+    {
+        return -1;
+    }
+    m_inputScale = scale;
+    return 0;
+}
+
+
+/**
+* Rotates the subcarrier layout of complex symbols, see SubcarrierLayout.
+* Rotating by nPoints/2 fuses Nyquist modulation into the transforms.
+* 
+* @param rotation number of points every index is shifted by
+*
+* @return 0 on success, else error number
+*
+*/
+inline int QamModulator::SetRotation(size_t rotation)
+{
+    return m_layout.SetRotation(rotation);
+}
+
+
+/**
+* @return channel estimator of the last demodulated symbol
+*/
+inline const ChannelEstimator &QamModulator::GetChannelEstimator() const
+{
+    return m_channelEstimator;
+}
+
+
+/**
+* Gathers the data points of the layout into the contiguous points
+* buffer, scaled by the input scale. With an equaliser selected, the
+* channel is estimated from the pilot tones and each point is 
+* multiplied by its coefficient in the same pass, the coefficients
+* already hold the input scale.
+* 
+* @param input pointer to the fft output, interleaved real and imag pairs
+*
+* @param nDataPoints number of data points of the layout
+*
+* @return true if the points have been equalised
+*
+*/
+inline bool QamModulator::GatherPoints(const double *input, size_t nDataPoints)
+{
+    const size_t *dataIndices = m_layout.GetDataIndices().data();
+    if( (m_channelEstimator.GetEqualiser() == EQUALISER_NONE) || (m_channelEstimator.Estimate(input, m_layout, m_inputScale) != 0) )
+    {
+        for(size_t point = 0; point < nDataPoints; point++)
+        {
+            m_points[point*2] = input[dataIndices[point]*2] * m_inputScale;
+            m_points[point*2+1] = input[dataIndices[point]*2+1] * m_inputScale;
+        }
+        return false;
+    }
+    const double *coefficients = m_channelEstimator.GetCoefficients().data();
+    for(size_t point = 0; point < nDataPoints; point++)
+    {
+        double real = input[dataIndices[point]*2];
+        double imag = input[dataIndices[point]*2+1];
+        m_points[point*2] = real * coefficients[point*2] - imag * coefficients[point*2+1];
+        m_points[point*2+1] = real * coefficients[point*2+1] + imag * coefficients[point*2];
+    }
+    return true;
 }
+
+
+/**
+* @param nDataPoints number of gathered data points
+*
+* @return mean squared distance of the gathered points to the nearest constellation point
+*
+*/
+inline double QamModulator::GetDecisionError(size_t nDataPoints) const
+{
+    if(nDataPoints == 0)
+    {
+        return 0.0;
+    }
+    double errorSum = 0.0;
+    for(size_t i = 0; i < nDataPoints*2; i++)
+    {
+        double level = (double) (2 * (int) SliceLevel(m_points[i]) - (int) (m_nLevels - 1)) * m_levelScale;
+        errorSum += (m_points[i] - level) * (m_points[i] - level);
+    }
+    return errorSum / (double) nDataPoints;
+}
+
+
+/**
+* Computes the maximum number of bytes which can be encoded
+* in one symbol. This depends on the size of the ifft
+* and pilot tone step, see SubcarrierLayout.
+* 
+* @return number of bytes per symbol
+*
+*/
+inline size_t QamModulator::GetMaxEncodedBytes() const
+{
+    if(!IsSupported(m_BitsPerSymbol))
+    {
+        return 0;
+    }
+    // Compute the equivelent of avaiable data bytes per symbol
+    return (size_t)((m_layout.GetMaxDataPoints() *  m_BitsPerSymbol)  / BITS_IN_BYTE);
+}
+
+
+/**
+* Computes the number of data points carrying nBytes, 
+* the bits of the last point may be partially used.
+* 
+* @param nBytes number of bytes encoded in the symbol
+*
+* @return number of data points
+*
+*/
+inline size_t QamModulator::GetDataPoints(size_t nBytes) const
+{
+    return (nBytes * BITS_IN_BYTE + m_BitsPerSymbol - 1) / m_BitsPerSymbol;
+}
+
+
+/**
+* @param bitsPerSymbol number of bits of each constellation point
+*
+* @return true for 4, 16, 64 and 256-QAM
+*
+*/
+inline bool QamModulator::IsSupported(size_t bitsPerSymbol)
+{
+    return (bitsPerSymbol >= 2) && (bitsPerSymbol <= QAM_MAX_BITS_PER_SYMBOL) && (bitsPerSymbol % 2 == 0);
+}
+
+
+/**
+* Builds the lookup tables of the constellation. Level i of an
+* axis has the amplitude (2i - (L-1)) * scale and carries the 
+* Gray code i ^ (i >> 1), so adjacent levels differ by one bit.
+* The scale sqrt(3 / (L^2 - 1)) gives each axis unit average energy.
+* 
+*/
+inline void QamModulator::ConfigureConstellation()
+{
+    if(!IsSupported(m_BitsPerSymbol))
+    {
+        return;
+    }
+    m_axisBits = m_BitsPerSymbol / 2;
+    m_nLevels = (size_t) 1 << m_axisBits;
+    m_levelScale = sqrt(3.0 / (double) (m_nLevels * m_nLevels - 1));
+    m_levels.resize(m_nLevels);
+    m_grayCode.resize(m_nLevels);
+    for(size_t i = 0; i < m_nLevels; i++)
+    {
+        size_t grayCode = i ^ (i >> 1);
+        m_grayCode[i] = (uint8_t) grayCode;
+        m_levels[grayCode] = (double) (2 * (int) i - (int) (m_nLevels - 1)) * m_levelScale;
+    }
+}
+
+
+/**
+* Maps the scrambled bytes of the symbol onto the data points through
+* the lookup tables. The bytes are read as a stream of bits starting
+* from the least significant bit, the lower half of the bits of each 
+* point is mapped onto the real and the upper half onto the imaginary
+* axis. Missing bits of the last point are zero.
+* 
+* @param dataIndices indices of the data points of the symbol
+*
+* @param output pointer to the ifft input, interleaved real and imag pairs
+*
+* @param nBytes number of bytes encoded in the symbol
+*
+*/
+inline void QamModulator::ModulateLUT(const size_t *dataIndices, double *output, size_t nBytes) const
+{
+    uint32_t axisMask = (uint32_t) m_nLevels - 1;
+    uint32_t symbolMask = ((uint32_t) 1 << m_BitsPerSymbol) - 1;
+    size_t nDataPoints = GetDataPoints(nBytes);
+    uint32_t bitBuffer = 0;
+    size_t nBits = 0;
+    size_t byteCounter = 0;
+    for(size_t point = 0; point < nDataPoints; point++)
+    {
+        // Refill the bit buffer
+        while(nBits < m_BitsPerSymbol)
+        {
+            uint32_t dataByte = (byteCounter < nBytes) ? m_scrambled[byteCounter] : 0;
+            bitBuffer |= dataByte << nBits;
+            nBits += BITS_IN_BYTE;
+            byteCounter++;
+        }
+        uint32_t symbol = bitBuffer & symbolMask;
+        bitBuffer >>= m_BitsPerSymbol;
+        nBits -= m_BitsPerSymbol;
+        output[dataIndices[point]*2] = m_levels[symbol & axisMask];
+        output[dataIndices[point]*2+1] = m_levels[symbol >> m_axisBits];
+    }
+}
+
+
+/**
+* Slices one axis of a received point to the nearest level
+* 
+* @param value real or imaginary part of the point
+*
+* @return index of the nearest level, from the most negative
+*
+*/
+inline size_t QamModulator::SliceLevel(double value) const
+{
+    // Level index is the distance from the most negative level in level spacings
+    double position = (value / m_levelScale + (double) (m_nLevels - 1)) * 0.5 + 0.5;
+    int level = (int) floor(position);
+    return (size_t) std::min(std::max(level, 0), (int) m_nLevels - 1);
+}
+
+
+/**
+* @param value real or imaginary part of the point
+*
+* @return axis bits of the nearest level
+*
+*/
+inline uint32_t QamModulator::SliceAxis(double value) const
+{
+    return m_grayCode[SliceLevel(value)];
+}
+
+
+/**
+* Hard decision demapping of the data points of the symbol
+* through slicing, the reverse of ModulateLUT.
+* 
+* @param points pointer to the gathered data points, interleaved real and imag pairs
+*
+* @param output pointer to the destination of nBytes decoded bytes
+*
+* @param nBytes The expected number of bytes to be decoded from the symbol
+*
+*/
+inline void QamModulator::DemodulateLUT(const double *points, uint8_t *output, size_t nBytes) const
+{
+    size_t nDataPoints = GetDataPoints(nBytes);
+    uint32_t bitBuffer = 0;
+    size_t nBits = 0;
+    size_t byteCounter = 0;
+    for(size_t point = 0; point < nDataPoints; point++)
+    {
+        uint32_t symbol = SliceAxis(points[point*2]);
+        symbol |= SliceAxis(points[point*2+1]) << m_axisBits;
+        bitBuffer |= symbol << nBits;
+        nBits += m_BitsPerSymbol;
+        // Flush completed bytes
+        while( (nBits >= BITS_IN_BYTE) && (byteCounter < nBytes) )
+        {
+            output[byteCounter] = (uint8_t) (bitBuffer & 0xFF);
+            bitBuffer >>= BITS_IN_BYTE;
+            nBits -= BITS_IN_BYTE;
+            byteCounter++;
+        }
+    }
+}
+
 #endif
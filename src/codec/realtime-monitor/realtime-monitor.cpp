@@ -0,0 +1,196 @@
+/**
+* @file realtime-monitor.cpp
+* @author Kamil Rog
+*
+*
+*/
+
+
+#include "realtime-monitor.h"
+#include <algorithm>
+#include <cmath>
+
+
+/**
+* Sets the sample rate the codec must keep up with and clears
+* the statistics. A sample rate of 0 disables the monitor.
+*
+* @param sampleRate samples per second of the Tx or Rx signal
+*
+* @param symbolPeriod number of samples of one symbol including
+* its cyclic prefix and guard interval
+*
+* @return 0 on success, -1 if the sample rate is negative
+*
+*/
+int RealTimeMonitor::Configure(double sampleRate, size_t symbolPeriod)
+{
+    if( !(sampleRate >= 0.0) )
+    {
+        return -1;
+    }
+    m_sampleRate = sampleRate;
+    m_symbolPeriod = symbolPeriod;
+    Reset();
+    return 0;
+}
+
+
+/**
+* @param nSamples number of samples processed
+*
+* @return time in nanoseconds the samples last at the sample rate, 0 if disabled
+*
+*/
+uint64_t RealTimeMonitor::GetBudget(size_t nSamples) const
+{
+    if(!IsEnabled())
+    {
+        return 0;
+    }
+    return (uint64_t) std::llround((double) nSamples * 1e9 / m_sampleRate);
+}
+
+
+/**
+* Reads the clock at the beginning of a monitored call,
+* the clock is not read if the monitor is disabled.
+*
+* @return start time of the call
+*
+*/
+std::chrono::steady_clock::time_point RealTimeMonitor::Start() const
+{
+    return IsEnabled() ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+}
+
+
+/**
+* Records a call which processed nSamples samples against
+* their time budget. Calls without samples, i.e. decodes
+* which have not found a symbol, are not recorded. Overruns
+* invoke the overrun callback on the calling thread.
+*
+* @param operation monitored operation
+*
+* @param start time returned by Start at the beginning of the call
+*
+* @param nSamples number of samples encoded or decoded by the call
+*
+*/
+void RealTimeMonitor::Record(MonitorOperation operation, std::chrono::steady_clock::time_point start, size_t nSamples)
+{
+    if( !IsEnabled() || (nSamples == 0) || (operation >= MONITOR_N_OPERATIONS) )
+    {
+        return;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    uint64_t elapsedNs = (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    uint64_t budgetNs = std::max(GetBudget(nSamples), (uint64_t) 1);
+
+    OperationCounters &counters = m_operations[operation];
+    counters.count.fetch_add(1, std::memory_order_relaxed);
+    counters.totalNs.fetch_add(elapsedNs, std::memory_order_relaxed);
+    counters.budgetNs.fetch_add(budgetNs, std::memory_order_relaxed);
+    uint64_t worstNs = counters.worstNs.load(std::memory_order_relaxed);
+    while( (elapsedNs > worstNs) && !counters.worstNs.compare_exchange_weak(worstNs, elapsedNs, std::memory_order_relaxed) )
+    {
+    }
+    uint64_t loadPpm = (uint64_t) ((double) elapsedNs * 1e6 / (double) budgetNs);
+    uint64_t worstLoadPpm = counters.worstLoadPpm.load(std::memory_order_relaxed);
+    while( (loadPpm > worstLoadPpm) && !counters.worstLoadPpm.compare_exchange_weak(worstLoadPpm, loadPpm, std::memory_order_relaxed) )
+    {
+    }
+
+    if(elapsedNs > budgetNs)
+    {
+        counters.overruns.fetch_add(1, std::memory_order_relaxed);
+        if(m_overrunCallback)
+        {
+            m_overrunCallback(operation, elapsedNs, budgetNs);
+        }
+    }
+}
+
+
+/**
+* Copies the deadline statistics of an operation
+*
+* @param operation monitored operation
+*
+* @param stats destination of the statistics
+*
+* @return 0 on success, -1 if the monitor is disabled
+*
+*/
+int RealTimeMonitor::GetStats(MonitorOperation operation, DeadlineStats &stats) const
+{
+    if( !IsEnabled() || (operation >= MONITOR_N_OPERATIONS) )
+    {
+        stats = DeadlineStats();
+        return -1;
+    }
+    const OperationCounters &counters = m_operations[operation];
+    stats.count = counters.count.load(std::memory_order_relaxed);
+    stats.overruns = counters.overruns.load(std::memory_order_relaxed);
+    stats.totalNs = counters.totalNs.load(std::memory_order_relaxed);
+    stats.budgetNs = counters.budgetNs.load(std::memory_order_relaxed);
+    stats.worstNs = counters.worstNs.load(std::memory_order_relaxed);
+    stats.worstLoad = (double) counters.worstLoadPpm.load(std::memory_order_relaxed) * 1e-6;
+    stats.load = stats.budgetNs ? (double) stats.totalNs / (double) stats.budgetNs : 0.0;
+    stats.headroom = stats.count ? 1.0 - stats.worstLoad : 0.0;
+    return 0;
+}
+
+
+/**
+* Estimates how many channels running the operation at the
+* sample rate fit on one core, based on the average load.
+*
+* @param operation monitored operation
+*
+* @return number of channels, 0 if nothing has been recorded
+*
+*/
+double RealTimeMonitor::GetChannelCapacity(MonitorOperation operation) const
+{
+    DeadlineStats stats;
+    if( (GetStats(operation, stats) != 0) || (stats.load <= 0.0) )
+    {
+        return 0.0;
+    }
+    return 1.0 / stats.load;
+}
+
+
+/**
+* Sets the function invoked on the thread of the codec after
+* every overrun, it should return quickly and must not call
+* back into the codec. Not thread safe with monitored calls,
+* set it before encoding or decoding.
+*
+* @param callback function to invoke, empty to remove
+*
+*/
+void RealTimeMonitor::SetOverrunCallback(const OverrunCallback &callback)
+{
+    m_overrunCallback = callback;
+}
+
+
+/**
+* Clears the statistics of all operations
+*
+*/
+void RealTimeMonitor::Reset()
+{
+    for(OperationCounters &counters : m_operations)
+    {
+        counters.count.store(0, std::memory_order_relaxed);
+        counters.overruns.store(0, std::memory_order_relaxed);
+        counters.totalNs.store(0, std::memory_order_relaxed);
+        counters.budgetNs.store(0, std::memory_order_relaxed);
+        counters.worstNs.store(0, std::memory_order_relaxed);
+        counters.worstLoadPpm.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,136 @@
+/**
+* @file realtime-monitor.h
+* @author Kamil Rog
+*
+* @section DESCRIPTION
+*
+* Real-time deadline monitor of the codec. At the configured
+* sample rate, every call processing nSamples samples must finish
+* within nSamples / sampleRate seconds to keep up with the
+* signal, e.g. one symbol period, prefix and guard interval
+* included, for each encoded or decoded symbol. Calls exceeding
+* their budget are counted as overruns and optionally reported
+* through a callback.
+*
+* The load, the time spent over the time budgeted, tells how
+* much of one core a channel occupies, so about 1 / load
+* channels fit on one core. The headroom of the worst call is
+* the fraction of its budget left, negative if it overran.
+*
+* Counters are relaxed atomics, recording never allocates or
+* locks and the statistics can be read from another thread.
+*/
+#ifndef REALTIME_MONITOR_H
+#define REALTIME_MONITOR_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+
+/**
+ * @brief Monitored codec operations
+ *
+ */
+enum MonitorOperation {
+	MONITOR_ENCODE,
+	MONITOR_DECODE,
+	MONITOR_N_OPERATIONS
+};
+
+
+/**
+ * @brief Deadline statistics of one operation
+ *
+ */
+struct DeadlineStats
+{
+    uint64_t count = 0; // Monitored calls
+    uint64_t overruns = 0; // Calls which exceeded their budget
+    uint64_t totalNs = 0; // Time spent in the calls
+    uint64_t budgetNs = 0; // Sum of the budgets of the calls
+    uint64_t worstNs = 0; // Longest call
+    double worstLoad = 0.0; // Highest ratio of the time of a call to its budget
+    double load = 0.0; // totalNs / budgetNs, the share of a core used in real-time
+    double headroom = 0.0; // 1 - worstLoad, negative if a call overran
+};
+
+
+/**
+ * @brief Per call time budget and overrun counter
+ *
+ */
+class RealTimeMonitor {
+
+public:
+
+	using OverrunCallback = std::function<void(MonitorOperation operation, uint64_t elapsedNs, uint64_t budgetNs)>;
+
+	RealTimeMonitor()
+	{
+		Reset();
+	}
+
+	int Configure(double sampleRate, size_t symbolPeriod);
+	bool IsEnabled() const;
+	double GetSampleRate() const;
+	uint64_t GetSymbolBudget() const;
+	uint64_t GetBudget(size_t nSamples) const;
+	std::chrono::steady_clock::time_point Start() const;
+	void Record(MonitorOperation operation, std::chrono::steady_clock::time_point start, size_t nSamples);
+	int GetStats(MonitorOperation operation, DeadlineStats &stats) const;
+	double GetChannelCapacity(MonitorOperation operation) const;
+	void SetOverrunCallback(const OverrunCallback &callback);
+	void Reset();
+
+private:
+
+	/**
+	 * @brief Atomic counters of one operation
+	 */
+	struct OperationCounters {
+		std::atomic<uint64_t> count;
+		std::atomic<uint64_t> overruns;
+		std::atomic<uint64_t> totalNs;
+		std::atomic<uint64_t> budgetNs;
+		std::atomic<uint64_t> worstNs;
+		std::atomic<uint64_t> worstLoadPpm; /// Worst load in parts per million
+	};
+
+	double m_sampleRate = 0.0;
+	size_t m_symbolPeriod = 0; /// Samples of one symbol including its prefix and guard interval
+	OperationCounters m_operations[MONITOR_N_OPERATIONS];
+	OverrunCallback m_overrunCallback;
+
+};
+
+
+/**
+* @return true if a sample rate has been configured
+*/
+inline bool RealTimeMonitor::IsEnabled() const
+{
+	return m_sampleRate > 0.0;
+}
+
+
+/**
+* @return samples per second of the monitored signal, 0 if disabled
+*/
+inline double RealTimeMonitor::GetSampleRate() const
+{
+	return m_sampleRate;
+}
+
+
+/**
+* @return time budget of one symbol in nanoseconds
+*/
+inline uint64_t RealTimeMonitor::GetSymbolBudget() const
+{
+	return GetBudget(m_symbolPeriod);
+}
+
+#endif
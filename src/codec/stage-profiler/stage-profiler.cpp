@@ -0,0 +1,129 @@
+/**
+* @file stage-profiler.cpp
+* @author Kamil Rog
+*
+*
+*/
+
+
+#include "stage-profiler.h"
+
+
+/**
+* Records one execution of a stage. Does not allocate or lock,
+* the counters of one execution are not updated atomically as
+* a whole, so a concurrent snapshot may be off by one execution.
+*
+* @param stage executed stage
+*
+* @param elapsedNs execution time in nanoseconds
+*
+*/
+void StageProfiler::Record(ProfileStage stage, uint64_t elapsedNs)
+{
+    if( (stage >= PROFILE_N_STAGES) || !IsEnabled() )
+    {
+        return;
+    }
+    StageCounters &counters = m_stages[stage];
+    counters.count.fetch_add(1, std::memory_order_relaxed);
+    counters.totalNs.fetch_add(elapsedNs, std::memory_order_relaxed);
+
+    uint64_t minNs = counters.minNs.load(std::memory_order_relaxed);
+    while( (elapsedNs < minNs) && !counters.minNs.compare_exchange_weak(minNs, elapsedNs, std::memory_order_relaxed) )
+    {
+    }
+    uint64_t maxNs = counters.maxNs.load(std::memory_order_relaxed);
+    while( (elapsedNs > maxNs) && !counters.maxNs.compare_exchange_weak(maxNs, elapsedNs, std::memory_order_relaxed) )
+    {
+    }
+
+    // Bucket of the most significant set bit
+    size_t bucket = 0;
+    while( (bucket + 1 < PROFILE_N_BUCKETS) && (elapsedNs >> (bucket + 1)) )
+    {
+        bucket++;
+    }
+    counters.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+
+/**
+* Copies the counters of all stages
+*
+* @param snapshot destination of the counters
+*
+*/
+void StageProfiler::GetSnapshot(ProfileSnapshot &snapshot) const
+{
+    for(size_t stage = 0; stage < PROFILE_N_STAGES; stage++)
+    {
+        const StageCounters &counters = m_stages[stage];
+        StageStats &stats = snapshot.stages[stage];
+        stats.count = counters.count.load(std::memory_order_relaxed);
+        stats.totalNs = counters.totalNs.load(std::memory_order_relaxed);
+        stats.maxNs = counters.maxNs.load(std::memory_order_relaxed);
+        uint64_t minNs = counters.minNs.load(std::memory_order_relaxed);
+        stats.minNs = (minNs == UINT64_MAX) ? 0 : minNs;
+        for(size_t bucket = 0; bucket < PROFILE_N_BUCKETS; bucket++)
+        {
+            stats.buckets[bucket] = counters.buckets[bucket].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+
+/**
+* Clears the counters of all stages
+*
+*/
+void StageProfiler::Reset()
+{
+    for(StageCounters &counters : m_stages)
+    {
+        counters.count.store(0, std::memory_order_relaxed);
+        counters.totalNs.store(0, std::memory_order_relaxed);
+        counters.minNs.store(UINT64_MAX, std::memory_order_relaxed);
+        counters.maxNs.store(0, std::memory_order_relaxed);
+        for(std::atomic<uint64_t> &bucket : counters.buckets)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+
+/**
+* Switches recording on or off at runtime
+*
+* @param enabled true to record the stages
+*
+*/
+void StageProfiler::SetEnabled(bool enabled)
+{
+    m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+
+/**
+* @param stage instrumented stage
+*
+* @return name of the stage, i.e. for the monitoring labels
+*
+*/
+const char *StageProfiler::GetStageName(ProfileStage stage)
+{
+    switch(stage)
+    {
+        case PROFILE_ENCODE:            return "encode";
+        case PROFILE_QAM_MODULATE:      return "qam_modulate";
+        case PROFILE_IFFT:              return "ifft";
+        case PROFILE_DECODE:            return "decode";
+        case PROFILE_COARSE_SEARCH:     return "coarse_search";
+        case PROFILE_FINE_SEARCH:       return "fine_search";
+        case PROFILE_TRACK:             return "track";
+        case PROFILE_FFT:               return "fft";
+        case PROFILE_QAM_DEMODULATE:    return "qam_demodulate";
+        default:                        return "unknown";
+    }
+}
@@ -0,0 +1,192 @@
+/**
+* @file stage-profiler.h
+* @author Kamil Rog
+*
+* @section DESCRIPTION
+*
+* Per stage latency counters of the codec and the detector.
+* Every stage keeps the number of executions, the total, minimum
+* and maximum time in nanoseconds and a histogram of fixed,
+* power of two buckets, bucket k counts executions which took
+* [2^k, 2^(k+1)) ns. Counters are relaxed atomics, so recording
+* never allocates or locks and a monitoring thread can take a
+* snapshot while the codec runs.
+*
+* Recording is compiled in only if OFDMLIB_PROFILING is defined,
+* see the OFDMLIB_PROFILING CMake option, otherwise the profile
+* macros expand to nothing. When compiled in, recording can also
+* be switched off at runtime.
+*/
+#ifndef STAGE_PROFILER_H
+#define STAGE_PROFILER_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <atomic>
+#include <chrono>
+
+#define PROFILE_N_BUCKETS 32 // Histogram buckets, the last one also counts longer executions
+
+
+/**
+ * @brief Instrumented stages
+ *
+ */
+enum ProfileStage {
+	PROFILE_ENCODE, // Encoding of a symbol, includes the stages below
+	PROFILE_QAM_MODULATE,
+	PROFILE_IFFT, // Inverse transform and Nyquist modulation
+	PROFILE_DECODE, // Decoding of a symbol, includes the stages below
+	PROFILE_COARSE_SEARCH, // Cyclic prefix correlation of the detector
+	PROFILE_FINE_SEARCH, // Pilot tone search of the detector
+	PROFILE_TRACK, // Symbol timing tracking of the detector while locked
+	PROFILE_FFT, // Nyquist demodulation and forward transform
+	PROFILE_QAM_DEMODULATE,
+	PROFILE_N_STAGES
+};
+
+
+/**
+ * @brief Counters of one stage
+ *
+ */
+struct StageStats
+{
+    uint64_t count = 0;
+    uint64_t totalNs = 0;
+    uint64_t minNs = 0; // 0 if the stage has not been executed
+    uint64_t maxNs = 0;
+    uint64_t buckets[PROFILE_N_BUCKETS] = {};
+};
+
+
+/**
+ * @brief Counters of all stages taken at one point in time
+ *
+ */
+struct ProfileSnapshot
+{
+    StageStats stages[PROFILE_N_STAGES];
+};
+
+
+/**
+ * @brief Lock free per stage latency recorder
+ *
+ */
+class StageProfiler {
+
+public:
+
+	StageProfiler()
+	{
+		Reset();
+	}
+
+	void Record(ProfileStage stage, uint64_t elapsedNs);
+	void GetSnapshot(ProfileSnapshot &snapshot) const;
+	void Reset();
+	void SetEnabled(bool enabled);
+	bool IsEnabled() const;
+	static const char *GetStageName(ProfileStage stage);
+	static bool IsCompiled();
+
+private:
+
+	/**
+	 * @brief Atomic counters of one stage
+	 */
+	struct StageCounters {
+		std::atomic<uint64_t> count;
+		std::atomic<uint64_t> totalNs;
+		std::atomic<uint64_t> minNs;
+		std::atomic<uint64_t> maxNs;
+		std::atomic<uint64_t> buckets[PROFILE_N_BUCKETS];
+	};
+
+	StageCounters m_stages[PROFILE_N_STAGES];
+	std::atomic<bool> m_enabled{true};
+
+};
+
+
+/**
+ * @brief Records the lifetime of the scope as one execution of a stage
+ *
+ */
+class ProfileScope {
+
+public:
+
+	/**
+	* Constructor starts the timer if the profiler is enabled
+	*
+	* @param profiler destination of the record, nothing is recorded if null
+	* @param stage stage executed within the scope
+	*
+	*/
+	ProfileScope(StageProfiler *profiler, ProfileStage stage) :
+	m_profiler( (profiler && profiler->IsEnabled()) ? profiler : nullptr ),
+	m_stage(stage)
+	{
+		if(m_profiler)
+		{
+			m_start = std::chrono::steady_clock::now();
+		}
+	}
+
+	/**
+	* Destructor records the elapsed time
+	*/
+	~ProfileScope()
+	{
+		if(m_profiler)
+		{
+			auto elapsed = std::chrono::steady_clock::now() - m_start;
+			m_profiler->Record(m_stage, (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+		}
+	}
+
+	ProfileScope(const ProfileScope &) = delete;
+	ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+
+	StageProfiler *m_profiler;
+	ProfileStage m_stage;
+	std::chrono::steady_clock::time_point m_start;
+
+};
+
+
+#ifdef OFDMLIB_PROFILING
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(profiler, stage) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(profiler, stage)
+#else
+#define PROFILE_SCOPE(profiler, stage) ((void) 0)
+#endif
+
+
+/**
+* @return true if recording is enabled at runtime
+*/
+inline bool StageProfiler::IsEnabled() const
+{
+	return m_enabled.load(std::memory_order_relaxed);
+}
+
+
+/**
+* @return true if the library has been built with OFDMLIB_PROFILING
+*/
+inline bool StageProfiler::IsCompiled()
+{
+#ifdef OFDMLIB_PROFILING
+	return true;
+#else
+	return false;
+#endif
+}
+
+#endif
@@ -0,0 +1,184 @@
+/**
+* @file subcarrier-layout.cpp
+* @author Kamil Rog
+*
+* 
+*/
+
+
+#include "subcarrier-layout.h"
+
+
+/**
+* Sets up the layout, the indices are computed by Update
+* 
+* @param nPoints Number of FFT / IFFT coefficients
+*
+* @param pilotToneStep number of points between pilot tones
+*
+* @param hermitian layout of the Hermitian spectrum of a real transform
+*
+* @return 0 on success, else error number
+*
+*/
+int SubcarrierLayout::Configure(size_t nPoints, size_t pilotToneStep, bool hermitian)
+{
+    if(pilotToneStep == 0)
+    {
+        return -1;
+    }
+    m_nPoints = nPoints;
+    m_pilotToneStep = pilotToneStep;
+    m_hermitian = hermitian;
+    m_rotation = 0;
+    m_nDataPoints = (size_t) -1;
+    // Reserve for every point, updating never allocates
+    m_data.reserve(nPoints);
+    m_pilots.reserve(nPoints);
+    m_data.clear();
+    m_pilots.clear();
+    return 0;
+}
+
+
+/**
+* Computes the indices for the number of data points, 
+* if they have not been computed for it already.
+* 
+* @param nDataPoints number of data points in the symbol
+*
+* @return 0 on success, -1 if the points do not fit in the symbol
+*
+*/
+int SubcarrierLayout::Update(size_t nDataPoints)
+{
+    if(nDataPoints == m_nDataPoints)
+    {
+        return 0;
+    }
+    if(nDataPoints > GetMaxDataPoints())
+    {
+        return -1;
+    }
+    m_data.clear();
+    m_pilots.clear();
+    if(m_hermitian)
+    {
+        UpdateHermitian(nDataPoints);
+    }
+    else
+    {
+        UpdateCentred(nDataPoints);
+    }
+    if(m_rotation)
+    {
+        for(size_t &index : m_data)
+        {
+            index = (index + m_rotation) % m_nPoints;
+        }
+        for(size_t &index : m_pilots)
+        {
+            index = (index + m_rotation) % m_nPoints;
+        }
+    }
+    m_nDataPoints = nDataPoints;
+    return 0;
+}
+
+
+/**
+* Shifts every index of the layout circularly, the indices are 
+* recomputed by the next update.
+* 
+* @param rotation number of points the indices are shifted by
+*
+* @return 0 on success, -1 for Hermitian layouts or rotations beyond the transform
+*
+*/
+int SubcarrierLayout::SetRotation(size_t rotation)
+{
+    if( rotation && (m_hermitian || (rotation >= m_nPoints)) )
+    {
+        return -1;
+    }
+    m_rotation = rotation;
+    m_nDataPoints = (size_t) -1;
+    return 0;
+}
+
+
+/**
+* @return number of data points of a full symbol
+*/
+size_t SubcarrierLayout::GetMaxDataPoints() const
+{
+    if(m_pilotToneStep == 0)
+    {
+        return 0;
+    }
+    if(m_hermitian)
+    {
+        // Positive frequencies excluding DC and Nyquist frequency
+        size_t nPositivePoints = m_nPoints/2 - 1;
+        return nPositivePoints - nPositivePoints/m_pilotToneStep;
+    }
+    return m_nPoints - m_nPoints/m_pilotToneStep;
+}
+
+
+/**
+* Points centred around DC. The first point lies in the negative 
+* frequencies, half a pilot tone step before the first pilot tone,
+* and the indices wrap to the positive frequencies.
+* 
+* @param nDataPoints number of data points in the symbol
+*
+*/
+void SubcarrierLayout::UpdateCentred(size_t nDataPoints)
+{
+    size_t pointIndex = (m_nPoints*2 - (m_nPoints*2) / m_pilotToneStep / 2 - nDataPoints / 2) / 2;
+    size_t pilotCounter = m_pilotToneStep / 2;
+    while(m_data.size() < nDataPoints)
+    {
+        // Pilot tone every pilot tone step points
+        if(pilotCounter == 0)
+        {
+            pilotCounter = m_pilotToneStep;
+            m_pilots.push_back(pointIndex);
+        }
+        else
+        {
+            m_data.push_back(pointIndex);
+            pilotCounter--;
+        }
+        pointIndex++;
+        // Wrap to positive frequencies
+        if(pointIndex == m_nPoints)
+        {
+            pointIndex = 0;
+        }
+    }
+}
+
+
+/**
+* Positive frequencies in ascending order. Pilot tones are placed 
+* at every multiple of the step, independently of the data points.
+* 
+* @param nDataPoints number of data points in the symbol
+*
+*/
+void SubcarrierLayout::UpdateHermitian(size_t nDataPoints)
+{
+    for(size_t pointIndex = 1; m_data.size() < nDataPoints; pointIndex++)
+    {
+        if( (pointIndex % m_pilotToneStep) != 0 )
+        {
+            m_data.push_back(pointIndex);
+        }
+    }
+    for(size_t pointIndex = m_pilotToneStep; pointIndex < m_nPoints/2; pointIndex += m_pilotToneStep)
+    {
+        m_pilots.push_back(pointIndex);
+    }
+}
@@ -0,0 +1,105 @@
+/**
+* @file subcarrier-layout.h
+* @author Kamil Rog
+*
+* @section DESCRIPTION
+*
+* Allocation of the transform points to data and pilot tones.
+* The indices are computed once for a number of data points, 
+* the modulator, demodulator and the pilot tone search then
+* gather and scatter the points through the flat index arrays
+* instead of counting pilot tones point by point.
+*
+* Complex transforms centre the used points around DC, starting 
+* with the negative frequencies, and insert a pilot tone every
+* pilot tone step points. Hermitian spectra of real transforms 
+* use the positive frequencies excluding DC and the Nyquist 
+* frequency, with pilot tones at every multiple of the step.
+*
+* Complex layouts may be rotated, every index is shifted circularly
+* by the rotation. Rotating by nPoints/2 places the points so that
+* the inverse transform output is already multiplied by (-1)^n,
+* i.e. Nyquist modulated, and the forward transform of samples 
+* which have not been Nyquist demodulated holds them at the same 
+* indices.
+*/
+#ifndef SUBCARRIER_LAYOUT_H
+#define SUBCARRIER_LAYOUT_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+
+#include "common.h"
+
+
+/**
+ * @brief Data and pilot tone indices of a symbol
+ * 
+ */
+class SubcarrierLayout {
+
+public:
+
+	/**
+	* Default constructor
+	*/
+	SubcarrierLayout()
+	{
+
+	}
+
+	/**
+	* Constructor runs configure function.
+	* 
+	* @param nPoints Number of FFT / IFFT coefficients
+	* @param pilotToneStep number of points between pilot tones
+	* @param hermitian layout of the Hermitian spectrum of a real transform
+	*
+	*/
+	SubcarrierLayout(size_t nPoints, size_t pilotToneStep, bool hermitian = false)
+	{
+		Configure(nPoints, pilotToneStep, hermitian);
+	}
+
+	int Configure(size_t nPoints, size_t pilotToneStep, bool hermitian = false);
+	int Update(size_t nDataPoints);
+	int SetRotation(size_t rotation);
+	const std::vector<size_t> &GetDataIndices() const;
+	const std::vector<size_t> &GetPilotIndices() const;
+	size_t GetMaxDataPoints() const;
+
+private:
+
+	void UpdateCentred(size_t nDataPoints);
+	void UpdateHermitian(size_t nDataPoints);
+
+	size_t m_nPoints = 0;
+	size_t m_pilotToneStep = 0;
+	bool m_hermitian = false;
+	size_t m_rotation = 0; /// Circular shift of every index of complex layouts
+	size_t m_nDataPoints = (size_t) -1; /// Number of data points the indices are computed for
+	std::vector<size_t> m_data; /// Index of each data point in the order the bits are mapped
+	std::vector<size_t> m_pilots; /// Index of each pilot tone
+
+};
+
+
+/**
+* @return indices of the data points
+*/
+inline const std::vector<size_t> &SubcarrierLayout::GetDataIndices() const
+{
+	return m_data;
+}
+
+
+/**
+* @return indices of the pilot tones
+*/
+inline const std::vector<size_t> &SubcarrierLayout::GetPilotIndices() const
+{
+	return m_pilots;
+}
+
+#endif
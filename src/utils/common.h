@@ -3,6 +3,8 @@
     
 #include <vector>
 
+#define BITS_IN_BYTE 8
+
     using DoubleVec = std::vector<double>;
     using ByteVec = std::vector<uint8_t>;
 
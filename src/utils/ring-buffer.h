@@ -0,0 +1,182 @@
+/**
+* @file ring-buffer.h
+* @author Kamil Rog
+*
+* @section DESCRIPTION
+*
+* Sample ring buffer used by the streaming decoder.
+* Every sample is stored twice, at its position and one
+* capacity further, so any run of up to capacity retained
+* samples can be read as one contiguous block without
+* unwrapping. Positions are absolute stream sample counts.
+*/
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <algorithm>
+
+#include "common.h"
+
+
+/**
+ * @brief Mirrored ring buffer of double samples
+ *
+ */
+class RingBuffer {
+
+public:
+
+	/**
+	* Default constructor
+	*/
+	RingBuffer() :
+	m_capacity(0),
+	m_head(0),
+	m_tail(0)
+	{
+
+	}
+
+	/**
+	* Constructor runs configure function.
+	*
+	* @param capacity maximum number of samples retained
+	*
+	*/
+	RingBuffer(size_t capacity)
+	{
+		Configure(capacity);
+	}
+
+	int Configure(size_t capacity);
+	void Reset();
+	size_t Push(const double *input, size_t nSamples);
+	void Consume(size_t position);
+	const double * Window(size_t position) const;
+
+	size_t GetHead() const;
+	size_t GetTail() const;
+	size_t GetFree() const;
+	size_t GetCapacity() const;
+
+private:
+
+	DoubleVec m_data;
+	size_t m_capacity;
+	size_t m_head; /// Absolute position one past the newest sample
+	size_t m_tail; /// Absolute position of the oldest retained sample
+
+};
+
+
+/**
+* Allocates storage for the buffer and resets the positions
+*
+* @param capacity maximum number of samples retained
+*
+* @return 0 on success, else error number
+*
+*/
+inline int RingBuffer::Configure(size_t capacity)
+{
+	m_capacity = capacity;
+	m_data.assign(capacity*2, 0.0);
+	Reset();
+	return 0;
+}
+
+
+/**
+* Discards all samples and restarts the stream at position 0
+*
+*/
+inline void RingBuffer::Reset()
+{
+	m_head = 0;
+	m_tail = 0;
+}
+
+
+/**
+* Appends as many samples as the free space allows
+*
+* @param input pointer to the samples
+*
+* @param nSamples number of samples available in the input
+*
+* @return number of samples pushed into the buffer
+*
+*/
+inline size_t RingBuffer::Push(const double *input, size_t nSamples)
+{
+	size_t nPushed = std::min(nSamples, GetFree());
+	if(nPushed == 0)
+	{
+		return 0;
+	}
+	// Samples up to the end of the storage, then the wrapped remainder
+	size_t index = m_head % m_capacity;
+	size_t nFirst = std::min(nPushed, m_capacity - index);
+	// Write the samples and their mirror
+	std::copy(input, input + nFirst, &m_data[index]);
+	std::copy(input, input + nFirst, &m_data[index + m_capacity]);
+	std::copy(input + nFirst, input + nPushed, &m_data[0]);
+	std::copy(input + nFirst, input + nPushed, &m_data[m_capacity]);
+	m_head += nPushed;
+	return nPushed;
+}
+
+
+/**
+* Releases all samples preceding specified position
+*
+* @param position absolute position of the oldest sample to keep
+*
+*/
+inline void RingBuffer::Consume(size_t position)
+{
+	m_tail = std::min(std::max(position, m_tail), m_head);
+}
+
+
+/**
+* Returns contiguous view of the retained samples
+*
+* @param position absolute position of the first sample in the view,
+* must not be smaller than the tail
+*
+* @return pointer to the sample, valid until head
+*
+*/
+inline const double * RingBuffer::Window(size_t position) const
+{
+	return &m_data[position % m_capacity];
+}
+
+
+inline size_t RingBuffer::GetHead() const
+{
+	return m_head;
+}
+
+
+inline size_t RingBuffer::GetTail() const
+{
+	return m_tail;
+}
+
+
+inline size_t RingBuffer::GetFree() const
+{
+	return m_capacity - (m_head - m_tail);
+}
+
+
+inline size_t RingBuffer::GetCapacity() const
+{
+	return m_capacity;
+}
+
+#endif
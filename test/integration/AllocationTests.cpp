@@ -0,0 +1,164 @@
+#define BOOST_TEST_MODULE AllocationTest
+#include <boost/test/unit_test.hpp>
+
+// For IO
+#include <stdlib.h>
+#include <math.h>
+#include <iostream>
+#include <unistd.h>
+#include <new>
+
+// For Random Float Generator
+#include <time.h>
+
+// For object under test
+#include "ofdmcodec.h"
+#include "common.h"
+
+// Number of calls to the global operator new
+static size_t nAllocations = 0;
+
+// Counting replacements of the global allocation functions
+void * operator new(size_t size)
+{
+    nAllocations++;
+    void *p = malloc(size ? size : 1);
+    if(p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void * operator new[](size_t size)
+{
+    nAllocations++;
+    void *p = malloc(size ? size : 1);
+    if(p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    free(p);
+}
+
+// Allocation Tests 
+BOOST_AUTO_TEST_SUITE(AllocationTests)
+
+/**
+*  Encodes and decodes symbols using caller owned buffers
+*  and checks that no heap allocation occurs on the way.
+* 
+*/
+BOOST_AUTO_TEST_CASE(EncodeDecodeNoAllocation)
+{
+    printf("Testing OFDM Encode & Decode Allocations...\n");
+    // Initialize ofdm coder setting structs and objects
+    OFDMSettings encoderSettings; 
+    encoderSettings.type = FFTW_BACKWARD;
+    encoderSettings.EnergyDispersalSeed = 0;
+    encoderSettings.nPoints = 512; 
+	encoderSettings.pilotToneStep = 8; 
+    encoderSettings.pilotToneAmplitude = 2.0; 
+    encoderSettings.guardInterval = 0; 
+    encoderSettings.QAMSize = 2; 
+    encoderSettings.cyclicPrefixSize = 128; 
+
+    OFDMSettings decoderSettings = encoderSettings;
+    decoderSettings.type = FFTW_FORWARD;
+
+    OFDMCodec encoder(encoderSettings);
+    OFDMCodec decoder(decoderSettings);
+
+    size_t nBytes = encoder.GetSymbolCapacity();
+    size_t symbolSize = encoder.GetSymbolSize();
+    size_t nSymbols = 8;
+
+    // Caller owned buffers, allocated up front
+    ByteVec txIn(nBytes);
+    ByteVec rxOut(nBytes);
+    DoubleVec txData(symbolSize);
+    DoubleVec rxSignal(symbolSize*3);
+
+    // Setup random byte generator
+    srand( (unsigned)time( NULL ) );
+
+    for (size_t symbol = 0; symbol < nSymbols; symbol++)
+    {
+        for (size_t i = 0; i < nBytes; i++)
+        {
+            txIn[i] = rand() % 255;
+        }
+        size_t prefixStart = rand() % symbolSize;
+        std::fill(rxSignal.begin(), rxSignal.end(), 0.0);
+
+        // Count allocations made by encoder
+        size_t nAllocationsBefore = nAllocations;
+        int encodeResult = encoder.Encode(txIn.data(), nBytes, txData.data(), txData.size());
+        size_t nEncodeAllocations = nAllocations - nAllocationsBefore;
+
+        std::copy(txData.begin(), txData.end(), rxSignal.begin()+prefixStart);
+
+        // Count allocations made by decoder
+        OFDMCodec symbolDecoder(decoderSettings);
+        nAllocationsBefore = nAllocations;
+        int decodeResult = symbolDecoder.Decode(rxSignal.data(), rxSignal.size(), rxOut.data(), nBytes);
+        size_t nDecodeAllocations = nAllocations - nAllocationsBefore;
+
+        BOOST_CHECK_MESSAGE( (encodeResult == 0), "Encode failed" );
+        BOOST_CHECK_MESSAGE( (decodeResult == 0), "Decode failed" );
+        BOOST_CHECK_MESSAGE( (nEncodeAllocations == 0), "Encode allocated " << nEncodeAllocations << " times" );
+        BOOST_CHECK_MESSAGE( (nDecodeAllocations == 0), "Decode allocated " << nDecodeAllocations << " times" );
+        for (size_t i = 0; i < nBytes; i++)
+        {
+            BOOST_CHECK_MESSAGE( (txIn[i] == rxOut[i]), "Bytes differ! - Occured at index: " << i ); 
+        }
+    }
+}
+
+
+/**
+*  Checks caller provided buffers which are too small are rejected
+* 
+*/
+BOOST_AUTO_TEST_CASE(BufferTooSmall)
+{
+    printf("Testing OFDM Encode Into Small Buffer...\n");
+    OFDMSettings encoderSettings; 
+    encoderSettings.type = FFTW_BACKWARD;
+    encoderSettings.EnergyDispersalSeed = 0;
+    encoderSettings.nPoints = 512; 
+	encoderSettings.pilotToneStep = 8; 
+    encoderSettings.pilotToneAmplitude = 2.0; 
+    encoderSettings.guardInterval = 0; 
+    encoderSettings.QAMSize = 2; 
+    encoderSettings.cyclicPrefixSize = 128; 
+
+    OFDMCodec encoder(encoderSettings);
+
+    ByteVec txIn(encoder.GetSymbolCapacity());
+    DoubleVec txData(encoder.GetSymbolSize() - 1);
+
+    BOOST_CHECK( encoder.Encode(txIn.data(), txIn.size(), txData.data(), txData.size()) == -1 );
+    BOOST_CHECK( encoder.Encode(txIn.data(), txIn.size() + 1, txData.data(), encoder.GetSymbolSize()) == -1 );
+}
+BOOST_AUTO_TEST_SUITE_END()
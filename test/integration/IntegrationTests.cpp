@@ -6,6 +6,8 @@
 #include <math.h>
 #include <iostream>
 #include <unistd.h>
+#include <dirent.h>
+#include <algorithm>
 
 // For measuring elapsed time
 #include <chrono>
@@ -121,4 +123,969 @@ BOOST_AUTO_TEST_CASE(EncodeDecode)
     }
     
 }
+
+/**
+*  This test encodes a payload spanning several symbols into
+*  one frame and decodes the symbols back one by one.
+* 
+*/
+BOOST_AUTO_TEST_CASE(EncodeDecodeFrame)
+{
+    printf("Testing OFDM Frame Encoder...\n");
+    // Initialize ofdm coder setting structs and objects
+    OFDMSettings encoderSettings; 
+    encoderSettings.type = FFTW_BACKWARD;
+    encoderSettings.EnergyDispersalSeed = 0;
+    encoderSettings.nPoints = 512; 
+	encoderSettings.pilotToneStep = 8; 
+    encoderSettings.pilotToneAmplitude = 2.0; 
+    encoderSettings.guardInterval = 0; 
+    encoderSettings.QAMSize = 2; 
+    encoderSettings.cyclicPrefixSize = 128; 
+
+    OFDMSettings decoderSettings = encoderSettings;
+    decoderSettings.type = FFTW_FORWARD;
+
+    OFDMCodec encoder(encoderSettings);
+
+    // Payload of three and a half symbols
+    size_t capacity = encoder.GetSymbolCapacity();
+    size_t nBytes = capacity*3 + capacity/2;
+    size_t nSymbols = 4;
+
+    // Setup random byte generator
+    srand( (unsigned)time( NULL ) );
+
+    ByteVec txIn(nBytes);
+    for (size_t i = 0; i < nBytes; i++)
+    {
+        txIn[i] = rand() % 255;
+    }
+
+    // Encode the whole payload in one pass
+    DoubleVec txData;
+    auto start = std::chrono::steady_clock::now();
+    size_t nEncodedSymbols = encoder.EncodeFrame(txIn, nBytes, txData);
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "Frame encode elapsed time: "
+    << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+    << " ns" << std::endl;
+
+    BOOST_CHECK_MESSAGE( (nEncodedSymbols == nSymbols), "Unexpected number of symbols: " << nEncodedSymbols );
+    BOOST_CHECK_MESSAGE( (txData.size() == nSymbols*encoder.GetSymbolSize()), "Unexpected frame size: " << txData.size() );
+
+    // Decode each symbol of the frame placed at a random position in the Rx signal buffer
+    size_t symbolSize = encoder.GetSymbolSize();
+    for (size_t symbol = 0; symbol < nSymbols; symbol++)
+    {
+        OFDMCodec decoder(decoderSettings);
+        size_t prefixStart = rand() % (symbolSize*4);
+        // Correlation has to fall below the threshold after the symbol
+        DoubleVec rxSignal(symbolSize*6);
+        std::copy(txData.begin()+symbol*symbolSize, txData.begin()+(symbol+1)*symbolSize, rxSignal.begin()+prefixStart);
+
+        ByteVec rxOut = decoder.Decode(rxSignal, capacity);
+        for (size_t i = 0; i < capacity; i++)
+        {
+            // The last symbol is padded with zeros
+            uint8_t expected = (symbol*capacity + i < nBytes) ? txIn[symbol*capacity + i] : 0;
+            BOOST_CHECK_MESSAGE( (expected == rxOut[i]), 
+            "Bytes differ! - Symbol: " << symbol << " Index: " << i ); 
+        }
+    }
+}
+
+/**
+*  This test checks that frames are not encoded from fewer
+*  bytes than requested or by a codec whose symbols carry no data.
+* 
+*/
+BOOST_AUTO_TEST_CASE(EncodeFrameInvalidInput)
+{
+    printf("Testing OFDM Frame Encoder Input Checks...\n");
+    OFDMSettings encoderSettings; 
+    encoderSettings.type = FFTW_BACKWARD;
+    encoderSettings.EnergyDispersalSeed = 0;
+    encoderSettings.nPoints = 512; 
+    encoderSettings.pilotToneStep = 8; 
+    encoderSettings.pilotToneAmplitude = 2.0; 
+    encoderSettings.guardInterval = 0; 
+    encoderSettings.QAMSize = 2; 
+    encoderSettings.cyclicPrefixSize = 128; 
+
+    OFDMCodec encoder(encoderSettings);
+    size_t capacity = encoder.GetSymbolCapacity();
+    ByteVec txIn(capacity*2, 0x5A);
+    DoubleVec txData(10, 1.0);
+    BOOST_CHECK( encoder.EncodeFrame(txIn, txIn.size() + 1, txData) == 0 );
+    BOOST_CHECK( txData.empty() );
+    BOOST_CHECK( encoder.EncodeFrame(txIn, txIn.size(), txData) == 2 );
+    BOOST_CHECK( txData.size() == 2*encoder.GetSymbolSize() );
+
+    // Every point is a pilot tone
+    encoderSettings.pilotToneStep = 1;
+    OFDMCodec pilotsOnly(encoderSettings);
+    BOOST_REQUIRE( pilotsOnly.GetSymbolCapacity() == 0 );
+    BOOST_CHECK( pilotsOnly.EncodeFrame(txIn, txIn.size(), txData) == 0 );
+    BOOST_CHECK( txData.empty() );
+    BOOST_CHECK( pilotsOnly.EncodeFrame(txIn, 0, txData) == 0 );
+}
+
+/**
+*  This test encodes a frame of symbols and feeds it to the
+*  streaming decoder in blocks of random size, so symbols
+*  are split across blocks.
+* 
+*/
+BOOST_AUTO_TEST_CASE(StreamDecode)
+{
+    printf("Testing OFDM Streaming Decoder...\n");
+    // Initialize ofdm coder setting structs and objects
+    OFDMSettings encoderSettings; 
+    encoderSettings.type = FFTW_BACKWARD;
+    encoderSettings.EnergyDispersalSeed = 0;
+    encoderSettings.nPoints = 512; 
+	encoderSettings.pilotToneStep = 8; 
+    encoderSettings.pilotToneAmplitude = 2.0; 
+    encoderSettings.guardInterval = 0; 
+    encoderSettings.QAMSize = 2; 
+    encoderSettings.cyclicPrefixSize = 128; 
+
+    OFDMSettings decoderSettings = encoderSettings;
+    decoderSettings.type = FFTW_FORWARD;
+
+    OFDMCodec encoder(encoderSettings);
+    OFDMCodec decoder(decoderSettings);
+
+    size_t capacity = encoder.GetSymbolCapacity();
+    size_t nSymbols = 6;
+    size_t nBytes = capacity*nSymbols;
+    size_t symbolSize = encoder.GetSymbolSize();
+
+    // Setup random byte generator
+    srand( (unsigned)time( NULL ) );
+
+    ByteVec txIn(nBytes);
+    for (size_t i = 0; i < nBytes; i++)
+    {
+        txIn[i] = rand() % 255;
+    }
+    DoubleVec txData = encoder.EncodeFrame(txIn, nBytes);
+
+    // Place the frame at a random position in the Rx signal buffer
+    size_t prefixStart = rand() % (symbolSize*4);
+    DoubleVec rxSignal(prefixStart + txData.size() + symbolSize);
+    std::copy(txData.begin(), txData.end(), rxSignal.begin()+prefixStart);
+    // Random block size, up to 1.5 symbols long
+    size_t blockSize = rand() % (symbolSize + symbolSize/2) + 1;
+    printf("Randomly Generated Prefix Start = %lu, Block Size = %lu\n", prefixStart, blockSize);
+
+    // Feed the signal block by block
+    ByteVec rxOut;
+    size_t nDecodedSymbols = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < rxSignal.size(); i += blockSize)
+    {
+        size_t nSamples = std::min(blockSize, rxSignal.size() - i);
+        nDecodedSymbols += decoder.DecodeStream(&rxSignal[i], nSamples, rxOut, capacity);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "Stream decode elapsed time: "
+    << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+    << " ns" << std::endl;
+
+    // Each symbol is emitted exactly once
+    BOOST_CHECK_MESSAGE( (nDecodedSymbols == nSymbols), "Unexpected number of symbols: " << nDecodedSymbols );
+    BOOST_REQUIRE_MESSAGE( (rxOut.size() == nBytes), "Unexpected number of bytes: " << rxOut.size() );
+    for (size_t i = 0; i < nBytes; i++)
+    {
+        BOOST_CHECK_MESSAGE( (txIn[i] == rxOut[i]), "Bytes differ! - Occured at index: " << i ); 
+    }
+}
+
+/**
+*  This test inserts a gap of random length in the middle of a
+*  streamed frame. The tracked timing no longer matches after 
+*  the gap, the decoder has to lose the lock and find the
+*  following symbols with the full search.
+* 
+*/
+BOOST_AUTO_TEST_CASE(StreamDecodeTimingJump)
+{
+    printf("Testing OFDM Streaming Decoder Timing Jump...\n");
+    // Initialize ofdm coder setting structs and objects
+    OFDMSettings encoderSettings; 
+    encoderSettings.type = FFTW_BACKWARD;
+    encoderSettings.EnergyDispersalSeed = 0;
+    encoderSettings.nPoints = 512; 
+	encoderSettings.pilotToneStep = 8; 
+    encoderSettings.pilotToneAmplitude = 2.0; 
+    encoderSettings.guardInterval = 0; 
+    encoderSettings.QAMSize = 2; 
+    encoderSettings.cyclicPrefixSize = 128; 
+
+    OFDMSettings decoderSettings = encoderSettings;
+    decoderSettings.type = FFTW_FORWARD;
+
+    OFDMCodec encoder(encoderSettings);
+    OFDMCodec decoder(decoderSettings);
+
+    size_t capacity = encoder.GetSymbolCapacity();
+    size_t nSymbols = 6;
+    size_t nBytes = capacity*nSymbols;
+    size_t symbolSize = encoder.GetSymbolSize();
+
+    // Setup random byte generator
+    srand( (unsigned)time( NULL ) );
+
+    ByteVec txIn(nBytes);
+    for (size_t i = 0; i < nBytes; i++)
+    {
+        txIn[i] = rand() % 255;
+    }
+    DoubleVec txData = encoder.EncodeFrame(txIn, nBytes);
+
+    // Split the frame in half with a gap longer than the tracking window
+    size_t prefixStart = rand() % (symbolSize*2);
+    size_t gap = rand() % encoderSettings.cyclicPrefixSize + 8;
+    size_t half = (nSymbols/2) * symbolSize;
+    DoubleVec rxSignal(prefixStart + txData.size() + gap + symbolSize);
+    std::copy(txData.begin(), txData.begin() + half, rxSignal.begin() + prefixStart);
+    std::copy(txData.begin() + half, txData.end(), rxSignal.begin() + prefixStart + half + gap);
+    size_t blockSize = rand() % (symbolSize + symbolSize/2) + 1;
+    printf("Randomly Generated Prefix Start = %lu, Gap = %lu, Block Size = %lu\n", prefixStart, gap, blockSize);
+
+    ByteVec rxOut;
+    size_t nDecodedSymbols = 0;
+    for (size_t i = 0; i < rxSignal.size(); i += blockSize)
+    {
+        size_t nSamples = std::min(blockSize, rxSignal.size() - i);
+        nDecodedSymbols += decoder.DecodeStream(&rxSignal[i], nSamples, rxOut, capacity);
+    }
+
+    BOOST_CHECK_MESSAGE( (nDecodedSymbols == nSymbols), "Unexpected number of symbols: " << nDecodedSymbols );
+    BOOST_REQUIRE_MESSAGE( (rxOut.size() == nBytes), "Unexpected number of bytes: " << rxOut.size() );
+    for (size_t i = 0; i < nBytes; i++)
+    {
+        BOOST_CHECK_MESSAGE( (txIn[i] == rxOut[i]), "Bytes differ! - Occured at index: " << i ); 
+    }
+}
+
+/**
+*  This test encodes frames with a guard interval between the
+*  symbols and decodes them block by block with the streaming
+*  decoder. The timing predicted one symbol period ahead must
+*  hold, so the full search runs only for the first symbol.
+* 
+*/
+BOOST_AUTO_TEST_CASE(StreamDecodeGuardInterval)
+{
+    printf("Testing OFDM Streaming Decoder Guard Interval...\n");
+
+    size_t nPoints = 512;
+    size_t nSymbols = 20;
+
+    // Setup random byte generator
+    srand( (unsigned)time( NULL ) );
+
+    for (size_t guardInterval : { (size_t) 0, (size_t) 8, nPoints/8, nPoints })
+    {
+        OFDMSettings encoderSettings; 
+        encoderSettings.type = FFTW_BACKWARD;
+        encoderSettings.EnergyDispersalSeed = 0;
+        encoderSettings.nPoints = nPoints; 
+        encoderSettings.pilotToneStep = 8; 
+        encoderSettings.pilotToneAmplitude = 2.0; 
+        encoderSettings.guardInterval = guardInterval; 
+        encoderSettings.QAMSize = 2; 
+        encoderSettings.cyclicPrefixSize = nPoints/4; 
+
+        OFDMSettings decoderSettings = encoderSettings;
+        decoderSettings.type = FFTW_FORWARD;
+
+        OFDMCodec encoder(encoderSettings);
+        OFDMCodec decoder(decoderSettings);
+
+        size_t capacity = encoder.GetSymbolCapacity();
+        size_t nBytes = capacity*nSymbols;
+        size_t symbolSize = encoder.GetSymbolSize();
+        size_t symbolPeriod = encoder.GetSymbolPeriod();
+
+        ByteVec txIn(nBytes);
+        for (size_t i = 0; i < nBytes; i++)
+        {
+            txIn[i] = rand() % 255;
+        }
+        DoubleVec txData = encoder.EncodeFrame(txIn, nBytes);
+        BOOST_REQUIRE_MESSAGE( (txData.size() == nSymbols*symbolPeriod), "Unexpected frame size: " << txData.size() );
+        BOOST_CHECK( encoder.GetFrameSize(nBytes) == txData.size() );
+        // Guard interval is silent
+        for (size_t symbol = 0; symbol < nSymbols; symbol++)
+        {
+            BOOST_CHECK( std::all_of(txData.begin() + symbol*symbolPeriod + symbolSize, txData.begin() + (symbol+1)*symbolPeriod,
+                                     [](double sample) { return sample == 0.0; }) );
+        }
+
+        size_t prefixStart = rand() % (symbolSize*2);
+        DoubleVec rxSignal(prefixStart + txData.size() + symbolSize);
+        std::copy(txData.begin(), txData.end(), rxSignal.begin() + prefixStart);
+        size_t blockSize = rand() % (symbolSize + symbolSize/2) + 1;
+        printf("Guard Interval = %lu, Prefix Start = %lu, Block Size = %lu\n", guardInterval, prefixStart, blockSize);
+
+        ByteVec rxOut;
+        size_t nDecodedSymbols = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < rxSignal.size(); i += blockSize)
+        {
+            size_t nSamples = std::min(blockSize, rxSignal.size() - i);
+            nDecodedSymbols += decoder.DecodeStream(&rxSignal[i], nSamples, rxOut, capacity);
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        std::cout << "Stream decode elapsed time: "
+        << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+        << " ns, full searches: " << decoder.GetAcquisitionCount() << std::endl;
+
+        BOOST_CHECK_MESSAGE( (decoder.GetAcquisitionCount() == 1), "Lock lost, full searches: " << decoder.GetAcquisitionCount() );
+        BOOST_CHECK_MESSAGE( (nDecodedSymbols == nSymbols), "Unexpected number of symbols: " << nDecodedSymbols );
+        BOOST_REQUIRE_MESSAGE( (rxOut.size() == nBytes), "Unexpected number of bytes: " << rxOut.size() );
+        BOOST_CHECK( rxOut == txIn );
+    }
+}
+
+/**
+*  This test encodes a frame using the real transform, which
+*  produces a real time series without Nyquist modulation, and
+*  decodes it block by block with the streaming decoder.
+* 
+*/
+BOOST_AUTO_TEST_CASE(RealTransformEncodeDecode)
+{
+    printf("Testing OFDM Real Transform Encoder & Decoder...\n");
+
+    size_t testSizes[] = { 1024, 8192 };
+    size_t nSymbols = 6;
+
+    // Setup random byte generator
+    srand( (unsigned)time( NULL ) );
+
+    for (size_t nPoints : testSizes)
+    {
+        // Initialize ofdm coder setting structs and objects
+        OFDMSettings encoderSettings; 
+        encoderSettings.type = FFTW_BACKWARD;
+        encoderSettings.EnergyDispersalSeed = 0;
+        encoderSettings.nPoints = nPoints; 
+        encoderSettings.pilotToneStep = 8; 
+        encoderSettings.pilotToneAmplitude = 2.0; 
+        encoderSettings.guardInterval = 0; 
+        encoderSettings.QAMSize = 2; 
+        encoderSettings.cyclicPrefixSize = nPoints/8; 
+        encoderSettings.transform = TRANSFORM_REAL;
+
+        OFDMSettings decoderSettings = encoderSettings;
+        decoderSettings.type = FFTW_FORWARD;
+
+        OFDMCodec encoder(encoderSettings);
+        OFDMCodec decoder(decoderSettings);
+
+        size_t capacity = encoder.GetSymbolCapacity();
+        size_t nBytes = capacity*nSymbols;
+        size_t symbolSize = encoder.GetSymbolSize();
+        BOOST_CHECK_MESSAGE( (symbolSize == nPoints + nPoints/8), "Unexpected symbol size: " << symbolSize );
+
+        ByteVec txIn(nBytes);
+        for (size_t i = 0; i < nBytes; i++)
+        {
+            txIn[i] = rand() % 255;
+        }
+        auto start = std::chrono::steady_clock::now();
+        DoubleVec txData = encoder.EncodeFrame(txIn, nBytes);
+        auto end = std::chrono::steady_clock::now();
+
+        std::cout << "nPoints = " << nPoints << " Real frame encode elapsed time: "
+        << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+        << " ns" << std::endl;
+
+        // Place the frame at a random position in the Rx signal buffer
+        size_t prefixStart = rand() % (symbolSize*2);
+        DoubleVec rxSignal(prefixStart + txData.size() + symbolSize);
+        std::copy(txData.begin(), txData.end(), rxSignal.begin()+prefixStart);
+        size_t blockSize = symbolSize/3;
+
+        ByteVec rxOut;
+        size_t nDecodedSymbols = 0;
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < rxSignal.size(); i += blockSize)
+        {
+            size_t nSamples = std::min(blockSize, rxSignal.size() - i);
+            nDecodedSymbols += decoder.DecodeStream(&rxSignal[i], nSamples, rxOut, capacity);
+        }
+        end = std::chrono::steady_clock::now();
+
+        std::cout << "nPoints = " << nPoints << " Real stream decode elapsed time: "
+        << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+        << " ns" << std::endl;
+
+        BOOST_CHECK_MESSAGE( (nDecodedSymbols == nSymbols), "Unexpected number of symbols: " << nDecodedSymbols );
+        BOOST_REQUIRE_MESSAGE( (rxOut.size() == nBytes), "Unexpected number of bytes: " << rxOut.size() );
+        for (size_t i = 0; i < nBytes; i++)
+        {
+            BOOST_CHECK_MESSAGE( (txIn[i] == rxOut[i]), "Bytes differ! - nPoints: " << nPoints << " Index: " << i ); 
+        }
+    }
+}
+
+/**
+*  This test encodes symbols with and without the spectral
+*  rotation which replaces the Nyquist modulator, checks the
+*  transmitted samples match and decodes them across both
+*  settings. Odd transform sizes keep the Nyquist modulator.
+*/
+BOOST_AUTO_TEST_CASE(SpectralRotation)
+{
+    printf("Testing OFDM Spectral Rotation...\n");
+
+    // Setup random byte generator
+    srand( (unsigned)time( NULL ) );
+
+    for(size_t nPoints : {1024, 1023})
+    {
+        OFDMSettings settings; 
+        settings.type = FFTW_BACKWARD;
+        settings.EnergyDispersalSeed = 0;
+        settings.nPoints = nPoints; 
+        settings.pilotToneStep = 8; 
+        settings.pilotToneAmplitude = 2.0; 
+        settings.guardInterval = 0; 
+        settings.QAMSize = 2; 
+        settings.cyclicPrefixSize = nPoints/8; 
+
+        OFDMSettings plainSettings = settings;
+        plainSettings.spectralRotation = false;
+
+        OFDMCodec rotatedEncoder(settings);
+        OFDMCodec plainEncoder(plainSettings);
+        settings.type = FFTW_FORWARD;
+        plainSettings.type = FFTW_FORWARD;
+        OFDMCodec rotatedDecoder(settings);
+        OFDMCodec plainDecoder(plainSettings);
+
+        size_t nBytes = rotatedEncoder.GetSymbolCapacity();
+        ByteVec txIn(nBytes);
+        for (size_t i = 0; i < nBytes; i++)
+        {
+            txIn[i] = rand() % 255;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        DoubleVec rotatedData = rotatedEncoder.Encode(txIn, nBytes);
+        auto end = std::chrono::steady_clock::now();
+        DoubleVec plainData = plainEncoder.Encode(txIn, nBytes);
+
+        std::cout << "nPoints = " << nPoints << " Rotated encode elapsed time: "
+        << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+        << " ns" << std::endl;
+
+        BOOST_REQUIRE_MESSAGE( (rotatedData.size() == plainData.size()), "Sizes differ! - nPoints: " << nPoints );
+        double maxDifference = 0.0;
+        for (size_t i = 0; i < rotatedData.size(); i++)
+        {
+            maxDifference = std::max(maxDifference, std::abs(rotatedData[i] - plainData[i]));
+        }
+        BOOST_CHECK_MESSAGE( (maxDifference < 1e-9), "Samples differ! - nPoints: " << nPoints << " Difference: " << maxDifference );
+
+        // Place each symbol at the same random position of an Rx signal
+        size_t prefixStart = rand() % (rotatedData.size() * 4);
+        DoubleVec rotatedSignal(rotatedData.size() * 6, 0.0);
+        DoubleVec plainSignal(rotatedData.size() * 6, 0.0);
+        std::copy(rotatedData.begin(), rotatedData.end(), rotatedSignal.begin()+prefixStart);
+        std::copy(plainData.begin(), plainData.end(), plainSignal.begin()+prefixStart);
+
+        ByteVec rotatedOut = rotatedDecoder.Decode(plainSignal, nBytes);
+        ByteVec plainOut = plainDecoder.Decode(rotatedSignal, nBytes);
+        for (size_t i = 0; i < nBytes; i++)
+        {
+            BOOST_CHECK_MESSAGE( (txIn[i] == rotatedOut[i]), "Rotated bytes differ! - nPoints: " << nPoints << " Index: " << i ); 
+            BOOST_CHECK_MESSAGE( (txIn[i] == plainOut[i]), "Plain bytes differ! - nPoints: " << nPoints << " Index: " << i ); 
+        }
+    }
+}
+
+/**
+*  This test encodes and decodes a symbol and checks the latency
+*  counters of each stage, if the library has been built with
+*  OFDMLIB_PROFILING, or that nothing is recorded otherwise.
+*  The histogram buckets are checked by recording known times.
+*/
+BOOST_AUTO_TEST_CASE(StageProfiling)
+{
+    printf("Testing OFDM Stage Profiling...\n");
+
+    size_t nPoints = 1024;
+
+    // Setup random byte generator
+    srand( (unsigned)time( NULL ) );
+
+    OFDMSettings encoderSettings; 
+    encoderSettings.type = FFTW_BACKWARD;
+    encoderSettings.EnergyDispersalSeed = 0;
+    encoderSettings.nPoints = nPoints; 
+    encoderSettings.pilotToneStep = 8; 
+    encoderSettings.pilotToneAmplitude = 2.0; 
+    encoderSettings.guardInterval = 0; 
+    encoderSettings.QAMSize = 2; 
+    encoderSettings.cyclicPrefixSize = nPoints/4; 
+
+    OFDMSettings decoderSettings = encoderSettings;
+    decoderSettings.type = FFTW_FORWARD;
+
+    OFDMCodec encoder(encoderSettings);
+    OFDMCodec decoder(decoderSettings);
+
+    size_t nBytes = encoder.GetSymbolCapacity();
+    ByteVec txIn(nBytes);
+    for (size_t i = 0; i < nBytes; i++)
+    {
+        txIn[i] = rand() % 255;
+    }
+    DoubleVec txData = encoder.Encode(txIn, nBytes);
+    size_t prefixStart = rand() % (txData.size() * 4);
+    DoubleVec rxSignal(txData.size() * 6, 0.0);
+    std::copy(txData.begin(), txData.end(), rxSignal.begin()+prefixStart);
+    ByteVec rxOut = decoder.Decode(rxSignal, nBytes);
+    BOOST_REQUIRE( rxOut == txIn );
+
+    ProfileSnapshot encoderProfile;
+    ProfileSnapshot decoderProfile;
+    int status = encoder.GetProfile(encoderProfile);
+    decoder.GetProfile(decoderProfile);
+    if(!StageProfiler::IsCompiled())
+    {
+        BOOST_CHECK( status == -1 );
+        for(size_t stage = 0; stage < PROFILE_N_STAGES; stage++)
+        {
+            BOOST_CHECK( (encoderProfile.stages[stage].count == 0) && (decoderProfile.stages[stage].count == 0) );
+        }
+        return;
+    }
+    BOOST_REQUIRE( status == 0 );
+
+    for(ProfileStage stage : { PROFILE_ENCODE, PROFILE_QAM_MODULATE, PROFILE_IFFT })
+    {
+        BOOST_CHECK_MESSAGE( (encoderProfile.stages[stage].count == 1), "Unexpected count of " << StageProfiler::GetStageName(stage) );
+    }
+    for(ProfileStage stage : { PROFILE_DECODE, PROFILE_COARSE_SEARCH, PROFILE_FINE_SEARCH, PROFILE_FFT, PROFILE_QAM_DEMODULATE })
+    {
+        BOOST_CHECK_MESSAGE( (decoderProfile.stages[stage].count == 1), "Unexpected count of " << StageProfiler::GetStageName(stage) );
+    }
+    for(size_t stage = 0; stage < PROFILE_N_STAGES; stage++)
+    {
+        const StageStats &stats = (stage < PROFILE_DECODE) ? encoderProfile.stages[stage] : decoderProfile.stages[stage];
+        uint64_t nBucketed = 0;
+        for(uint64_t bucket : stats.buckets)
+        {
+            nBucketed += bucket;
+        }
+        BOOST_CHECK_MESSAGE( (nBucketed == stats.count), "Histogram does not match the count of " << StageProfiler::GetStageName((ProfileStage) stage) );
+        BOOST_CHECK( (stats.minNs <= stats.maxNs) && (stats.maxNs <= stats.totalNs) );
+        std::cout << StageProfiler::GetStageName((ProfileStage) stage) << " elapsed time: " << stats.totalNs << " ns" << std::endl;
+    }
+    // Stages are part of the whole decode
+    const StageStats *stages = decoderProfile.stages;
+    BOOST_CHECK( stages[PROFILE_COARSE_SEARCH].totalNs + stages[PROFILE_FINE_SEARCH].totalNs + stages[PROFILE_TRACK].totalNs + 
+                 stages[PROFILE_FFT].totalNs + stages[PROFILE_QAM_DEMODULATE].totalNs <= stages[PROFILE_DECODE].totalNs );
+
+    // Nothing is recorded when switched off at runtime
+    decoder.SetProfiling(false);
+    decoder.ResetStream();
+    decoder.Decode(rxSignal, nBytes);
+    ProfileSnapshot disabledProfile;
+    decoder.GetProfile(disabledProfile);
+    BOOST_CHECK( disabledProfile.stages[PROFILE_DECODE].count == 1 );
+
+    // Bucket k counts [2^k, 2^(k+1)) ns
+    decoder.ResetProfile();
+    decoder.GetProfile(disabledProfile);
+    BOOST_CHECK( disabledProfile.stages[PROFILE_DECODE].count == 0 );
+    StageProfiler profiler;
+    profiler.Record(PROFILE_FFT, 0);
+    profiler.Record(PROFILE_FFT, 1000);
+    profiler.Record(PROFILE_FFT, 1024);
+    profiler.Record(PROFILE_FFT, UINT64_MAX);
+    ProfileSnapshot snapshot;
+    profiler.GetSnapshot(snapshot);
+    const StageStats &stats = snapshot.stages[PROFILE_FFT];
+    BOOST_CHECK( stats.count == 4 );
+    BOOST_CHECK( (stats.minNs == 0) && (stats.maxNs == UINT64_MAX) );
+    BOOST_CHECK( (stats.buckets[0] == 1) && (stats.buckets[9] == 1) && (stats.buckets[10] == 1) && (stats.buckets[PROFILE_N_BUCKETS-1] == 1) );
+}
+
+/**
+*  This test checks the deadlines of encoding and decoding
+*  at a sample rate the codec can not keep up with,
+*  which overruns every call, and at a slow one which never does.
+*/
+BOOST_AUTO_TEST_CASE(DeadlineMonitor)
+{
+    printf("Testing OFDM Real-Time Monitor...\n");
+
+    size_t nPoints = 1024;
+
+    // Setup random byte generator
+    srand( (unsigned)time( NULL ) );
+
+    OFDMSettings encoderSettings;
+    encoderSettings.type = FFTW_BACKWARD;
+    encoderSettings.EnergyDispersalSeed = 0;
+    encoderSettings.nPoints = nPoints;
+    encoderSettings.pilotToneStep = 8;
+    encoderSettings.pilotToneAmplitude = 2.0;
+    encoderSettings.guardInterval = 0;
+    encoderSettings.QAMSize = 2;
+    encoderSettings.cyclicPrefixSize = nPoints/4;
+
+    // Disabled by default
+    OFDMCodec unmonitored(encoderSettings);
+    DeadlineStats stats;
+    BOOST_CHECK( !unmonitored.GetMonitor().IsEnabled() );
+    BOOST_CHECK( unmonitored.GetMonitor().GetStats(MONITOR_ENCODE, stats) == -1 );
+
+    // Budget of one nanosecond per symbol
+    encoderSettings.sampleRate = 1e15;
+    OFDMSettings decoderSettings = encoderSettings;
+    decoderSettings.type = FFTW_FORWARD;
+    decoderSettings.sampleRate = 1e3;
+
+    OFDMCodec encoder(encoderSettings);
+    OFDMCodec decoder(decoderSettings);
+    BOOST_CHECK( encoder.GetSymbolPeriod() == encoder.GetSymbolSize() );
+    BOOST_CHECK( decoder.GetMonitor().GetSymbolBudget() == (uint64_t) (decoder.GetSymbolPeriod() * 1000000) );
+
+    size_t nOverruns = 0;
+    encoder.GetMonitor().SetOverrunCallback([&nOverruns](MonitorOperation operation, uint64_t elapsedNs, uint64_t budgetNs)
+    {
+        BOOST_CHECK( (operation == MONITOR_ENCODE) && (elapsedNs > budgetNs) );
+        nOverruns++;
+    });
+
+    size_t nBytes = encoder.GetSymbolCapacity();
+    ByteVec txIn(nBytes);
+    for (size_t i = 0; i < nBytes; i++)
+    {
+        txIn[i] = rand() % 255;
+    }
+    auto start = std::chrono::steady_clock::now();
+    DoubleVec txData = encoder.Encode(txIn, nBytes);
+    auto end = std::chrono::steady_clock::now();
+    size_t prefixStart = rand() % (txData.size() * 4);
+    DoubleVec rxSignal(txData.size() * 6, 0.0);
+    std::copy(txData.begin(), txData.end(), rxSignal.begin()+prefixStart);
+    ByteVec rxOut = decoder.Decode(rxSignal, nBytes);
+    BOOST_REQUIRE( rxOut == txIn );
+    std::cout << "Monitored encode elapsed time: " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << " ns" << std::endl;
+
+    // Every encode overruns
+    ByteVec frameIn(nBytes * 3);
+    DoubleVec frame;
+    BOOST_CHECK( encoder.EncodeFrame(frameIn, frameIn.size(), frame) == 3 );
+    BOOST_REQUIRE( encoder.GetMonitor().GetStats(MONITOR_ENCODE, stats) == 0 );
+    BOOST_CHECK( (stats.count == 2) && (stats.overruns == 2) && (nOverruns == 2) );
+    BOOST_CHECK( stats.budgetNs == 2 );
+    BOOST_CHECK( (stats.worstNs > 0) && (stats.worstNs <= stats.totalNs) );
+    BOOST_CHECK( (stats.load > 1.0) && (stats.headroom < 0.0) );
+    BOOST_CHECK( encoder.GetMonitor().GetStats(MONITOR_DECODE, stats) == 0 );
+    BOOST_CHECK( stats.count == 0 );
+
+    // Decoding at 1 kS/s leaves seconds per symbol
+    BOOST_REQUIRE( decoder.GetMonitor().GetStats(MONITOR_DECODE, stats) == 0 );
+    BOOST_CHECK( (stats.count == 1) && (stats.overruns == 0) );
+    BOOST_CHECK( stats.budgetNs == decoder.GetMonitor().GetSymbolBudget() );
+    BOOST_CHECK( (stats.load > 0.0) && (stats.load < 1.0) && (stats.headroom > 0.0) );
+    BOOST_CHECK( decoder.GetMonitor().GetChannelCapacity(MONITOR_DECODE) > 1.0 );
+    std::cout << "Decoder load: " << stats.load << ", channels per core: " << decoder.GetMonitor().GetChannelCapacity(MONITOR_DECODE) << std::endl;
+
+    // Failed decodes are not recorded
+    DoubleVec silence(txData.size() * 2, 0.0);
+    decoder.ResetStream();
+    decoder.Decode(silence, nBytes);
+    decoder.GetMonitor().GetStats(MONITOR_DECODE, stats);
+    BOOST_CHECK( stats.count == 1 );
+
+    decoder.GetMonitor().Reset();
+    decoder.GetMonitor().GetStats(MONITOR_DECODE, stats);
+    BOOST_CHECK( (stats.count == 0) && (stats.worstNs == 0) );
+    BOOST_CHECK( decoder.GetMonitor().Configure(-1.0, decoder.GetSymbolPeriod()) == -1 );
+}
+
+/**
+*  This test passes a 16-QAM real transform frame through a 
+*  multipath channel, an echo within the cyclic prefix, and 
+*  stream decodes it with the zero forcing equaliser.
+*/
+BOOST_AUTO_TEST_CASE(EqualisedMultipathDecode)
+{
+    printf("Testing OFDM Equalised Multipath Decoder...\n");
+
+    size_t nPoints = 1024;
+    size_t nSymbols = 6;
+
+    // Setup random byte generator
+    srand( (unsigned)time( NULL ) );
+
+    OFDMSettings encoderSettings; 
+    encoderSettings.type = FFTW_BACKWARD;
+    encoderSettings.EnergyDispersalSeed = 0;
+    encoderSettings.nPoints = nPoints; 
+    encoderSettings.pilotToneStep = 8; 
+    encoderSettings.pilotToneAmplitude = 2.0; 
+    encoderSettings.guardInterval = 0; 
+    encoderSettings.QAMSize = 4; 
+    encoderSettings.cyclicPrefixSize = nPoints/8; 
+    encoderSettings.transform = TRANSFORM_REAL;
+
+    OFDMSettings decoderSettings = encoderSettings;
+    decoderSettings.type = FFTW_FORWARD;
+    decoderSettings.equaliser = EQUALISER_ZF;
+
+    OFDMCodec encoder(encoderSettings);
+    OFDMCodec decoder(decoderSettings);
+
+    size_t capacity = encoder.GetSymbolCapacity();
+    size_t nBytes = capacity*nSymbols;
+    size_t symbolSize = encoder.GetSymbolSize();
+
+    ByteVec txIn(nBytes);
+    for (size_t i = 0; i < nBytes; i++)
+    {
+        txIn[i] = rand() % 255;
+    }
+    DoubleVec txData = encoder.EncodeFrame(txIn, nBytes);
+
+    // Direct path and two echoes
+    size_t prefixStart = rand() % (symbolSize*2);
+    DoubleVec rxSignal(prefixStart + txData.size() + symbolSize, 0.0);
+    for (size_t i = 0; i < txData.size(); i++)
+    {
+        rxSignal[prefixStart + i] += 0.8 * txData[i];
+        rxSignal[prefixStart + i + 3] += 0.45 * txData[i];
+        rxSignal[prefixStart + i + 9] -= 0.2 * txData[i];
+    }
+    size_t blockSize = symbolSize/3;
+
+    ByteVec rxOut;
+    size_t nDecodedSymbols = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < rxSignal.size(); i += blockSize)
+    {
+        size_t nSamples = std::min(blockSize, rxSignal.size() - i);
+        nDecodedSymbols += decoder.DecodeStream(&rxSignal[i], nSamples, rxOut, capacity);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "nPoints = " << nPoints << " Equalised stream decode elapsed time: "
+    << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+    << " ns" << std::endl;
+
+    BOOST_CHECK_MESSAGE( (nDecodedSymbols == nSymbols), "Unexpected number of symbols: " << nDecodedSymbols );
+    BOOST_REQUIRE_MESSAGE( (rxOut.size() == nBytes), "Unexpected number of bytes: " << rxOut.size() );
+    for (size_t i = 0; i < nBytes; i++)
+    {
+        BOOST_CHECK_MESSAGE( (txIn[i] == rxOut[i]), "Bytes differ! - Index: " << i ); 
+    }
+}
+
+/**
+*  This test encodes and decodes frames of 64 symbols one
+*  symbol per transform (K=1) and a batch of 64 symbols per
+*  transform (K=64) and compares the elapsed times.
+* 
+*/
+BOOST_AUTO_TEST_CASE(BatchEncodeDecode)
+{
+    printf("Testing OFDM Batch Encoder & Decoder...\n");
+
+    size_t testSizes[] = { 512, 4096 };
+    size_t batchSizes[] = { 1, 64 };
+    size_t nSymbols = 64;
+
+    // Setup random byte generator
+    srand( (unsigned)time( NULL ) );
+
+    for (size_t nPoints : testSizes)
+    {
+        for (size_t nBatch : batchSizes)
+        {
+            // Initialize ofdm coder setting structs and objects
+            OFDMSettings encoderSettings; 
+            encoderSettings.type = FFTW_BACKWARD;
+            encoderSettings.EnergyDispersalSeed = 0;
+            encoderSettings.nPoints = nPoints; 
+            encoderSettings.pilotToneStep = 8; 
+            encoderSettings.pilotToneAmplitude = 2.0; 
+            encoderSettings.guardInterval = 0; 
+            encoderSettings.QAMSize = 2; 
+            encoderSettings.cyclicPrefixSize = nPoints/4; 
+
+            OFDMSettings decoderSettings = encoderSettings;
+            decoderSettings.type = FFTW_FORWARD;
+
+            OFDMCodec encoder(encoderSettings);
+            OFDMCodec decoder(decoderSettings);
+            // K=1 runs the single transform path
+            if(nBatch > 1)
+            {
+                encoder.ConfigureBatch(nBatch);
+                decoder.ConfigureBatch(nBatch);
+            }
+
+            size_t capacity = encoder.GetSymbolCapacity();
+            size_t nBytes = capacity*nSymbols;
+            ByteVec txIn(nBytes);
+            ByteVec rxOut(nBytes);
+            for (size_t i = 0; i < nBytes; i++)
+            {
+                txIn[i] = rand() % 255;
+            }
+
+            DoubleVec txData;
+            auto start = std::chrono::steady_clock::now();
+            encoder.EncodeFrame(txIn, nBytes, txData);
+            auto end = std::chrono::steady_clock::now();
+            auto encodeTime = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+            // Place the frame at a random position in the Rx signal buffer
+            size_t prefixStart = rand() % encoder.GetSymbolSize();
+            DoubleVec rxSignal(prefixStart + txData.size() + encoder.GetSymbolSize());
+            std::copy(txData.begin(), txData.end(), rxSignal.begin()+prefixStart);
+
+            start = std::chrono::steady_clock::now();
+            size_t nDecoded = decoder.DecodeBatch(rxSignal.data(), rxSignal.size(), rxOut.data(), nSymbols);
+            end = std::chrono::steady_clock::now();
+            auto decodeTime = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+            std::cout << "nPoints = " << nPoints << " K = " << nBatch 
+            << " Encode time per symbol: " << encodeTime / nSymbols << " ns"
+            << " Decode time per symbol: " << decodeTime / nSymbols << " ns" << std::endl;
+
+            BOOST_CHECK_MESSAGE( (nDecoded == nSymbols), "Unexpected number of symbols: " << nDecoded );
+            for (size_t i = 0; i < nBytes; i++)
+            {
+                BOOST_CHECK_MESSAGE( (txIn[i] == rxOut[i]), 
+                "Bytes differ! - nPoints: " << nPoints << " K: " << nBatch << " Index: " << i ); 
+            }
+        }
+    }
+}
+/**
+*  This test constructs a codec which measures its plans and stores
+*  the wisdom in a file, then constructs a codec which plans from 
+*  the file only. Both construction times are printed and the second 
+*  codec must decode the symbol encoded by the first one.
+* 
+*/
+BOOST_AUTO_TEST_CASE(WisdomFile)
+{
+    printf("Testing OFDM Codec Wisdom File...\n");
+
+    // Setup random byte generator
+    srand( (unsigned)time( NULL ) );
+
+    std::string wisdomFile = "ofdmlib-test-wisdom-" + std::to_string(getpid());
+
+    // Initialize ofdm coder setting structs and objects
+    OFDMSettings encoderSettings; 
+    encoderSettings.type = FFTW_BACKWARD;
+    encoderSettings.EnergyDispersalSeed = 0;
+    encoderSettings.nPoints = 4096; 
+    encoderSettings.pilotToneStep = 8; 
+    encoderSettings.pilotToneAmplitude = 2.0; 
+    encoderSettings.guardInterval = 0; 
+    encoderSettings.QAMSize = 2; 
+    encoderSettings.cyclicPrefixSize = 1024; 
+    encoderSettings.plannerEffort = PLANNER_MEASURE;
+    encoderSettings.wisdomFile = wisdomFile;
+
+    OFDMSettings decoderSettings = encoderSettings;
+    decoderSettings.type = FFTW_FORWARD;
+
+    ofdmFFT::ForgetWisdom();
+    auto start = std::chrono::steady_clock::now();
+    OFDMCodec encoder(encoderSettings);
+    OFDMCodec measuredDecoder(decoderSettings);
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "Cold construction elapsed time: "
+    << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+    << " ns" << std::endl;   
+
+    BOOST_REQUIRE_MESSAGE( (access(wisdomFile.c_str(), F_OK) == 0), "Wisdom file has not been created" );
+
+    // Plans of an identical codec come from the cache, there is nothing new to save
+    std::remove(wisdomFile.c_str());
+    {
+        OFDMCodec cachedDecoder(decoderSettings);
+    }
+    BOOST_CHECK_MESSAGE( (access(wisdomFile.c_str(), F_OK) != 0), "Wisdom file rewritten without new wisdom" );
+    BOOST_REQUIRE_EQUAL( ofdmFFT::ExportWisdom(wisdomFile), 0 );
+
+    // No temporary files are left behind
+    DIR *directory = opendir(".");
+    BOOST_REQUIRE( directory != NULL );
+    std::string tempPrefix = wisdomFile + ".";
+    for(struct dirent *entry = readdir(directory); entry != NULL; entry = readdir(directory))
+    {
+        BOOST_CHECK_MESSAGE( (std::string(entry->d_name).compare(0, tempPrefix.size(), tempPrefix) != 0),
+                             "Temporary wisdom file left behind: " << entry->d_name );
+    }
+    closedir(directory);
+
+    // Simulate process restart
+    ofdmFFT::ForgetWisdom();
+    decoderSettings.plannerEffort = PLANNER_WISDOM_ONLY;
+    uint64_t nMisses = FFTPlanCache::GetWisdomMissCount();
+    start = std::chrono::steady_clock::now();
+    OFDMCodec decoder(decoderSettings);
+    end = std::chrono::steady_clock::now();
+
+    std::cout << "Warm construction elapsed time: "
+    << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+    << " ns" << std::endl;   
+
+    // Every plan of the warm decoder has been planned from the imported file
+    BOOST_CHECK_MESSAGE( (FFTPlanCache::GetWisdomMissCount() == nMisses), 
+    "Plans estimated without wisdom: " << FFTPlanCache::GetWisdomMissCount() - nMisses );
+    // Without the file the same planner effort has to estimate
+    {
+        ofdmFFT::ForgetWisdom();
+        OFDMSettings unknownSettings = decoderSettings;
+        unknownSettings.nPoints = 2048;
+        unknownSettings.cyclicPrefixSize = 512;
+        unknownSettings.wisdomFile.clear();
+        OFDMCodec unknownDecoder(unknownSettings);
+        BOOST_CHECK( FFTPlanCache::GetWisdomMissCount() > nMisses );
+    }
+
+    size_t nBytes = encoder.GetSymbolCapacity();
+    ByteVec txIn(nBytes);
+    for(size_t i = 0; i < nBytes; i++)
+    {
+        txIn[i] = rand() % 255;
+    }
+    DoubleVec symbol = encoder.Encode(txIn, nBytes);
+    DoubleVec rxSignal(symbol.size() * 2);
+    std::copy(symbol.begin(), symbol.end(), rxSignal.begin() + symbol.size() / 2);
+    ByteVec rxOut = decoder.Decode(rxSignal, nBytes);
+
+    for(size_t i = 0; i < nBytes; i++)
+    {
+        BOOST_CHECK_MESSAGE( (txIn[i] == rxOut[i]), "Bytes differ! - Index: " << i );
+    }
+
+    std::remove(wisdomFile.c_str());
+    ofdmFFT::ForgetWisdom();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
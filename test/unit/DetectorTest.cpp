@@ -8,6 +8,7 @@
 #include <iostream>
 #include <unistd.h>
 #include <vector>
+#include <random>
 
 // Plotting library 
 #include <boost/tuple/tuple.hpp>
@@ -178,6 +179,96 @@ BOOST_AUTO_TEST_CASE(CorrelatorTest)
         
 }
 
+/**
+* Searches every symbol of a long frame of back to back symbols
+* with the streaming search. The correlation of adjacent symbols
+* forms a plateau, the prefix start must still be found exactly.
+* The correlation maximum around each prefix start is reported for comparison.
+* 
+*/
+BOOST_AUTO_TEST_CASE(StreamSearchTest)
+{
+    printf("\nTesting Streaming Search of Back to Back Symbols...\n");
+
+    size_t nPoints = 512;
+    size_t symbolSize = nPoints*2;
+    size_t prefixSize = symbolSize / 8;
+    size_t symbolSizeWithPrefx = symbolSize + prefixSize;
+    size_t pilotToneStep = 8;
+    double pilotToneAmplitude = 2.0;
+    size_t energyDispersalSeed = 10;
+    size_t bitsPerSymbol = 2;
+    size_t nSymbols = 64;
+
+    // Own generator of fixed seed, the result must not depend on the run
+    // nor on the use of rand() by the modulator
+    std::mt19937 generator(5);
+    std::uniform_int_distribution<int> byteDistribution(0, 255);
+
+    // Initialize Encoder objects
+    QamModulator qam(nPoints, pilotToneStep, pilotToneAmplitude, energyDispersalSeed, bitsPerSymbol);
+    ofdmFFT ifft(nPoints, FFTW_BACKWARD, pilotToneStep);
+    NyquistModulator nyquistModulator(nPoints, ifft.out);
+
+    // Initialize Decoder objects
+    ofdmFFT fft(nPoints, FFTW_FORWARD, pilotToneStep);
+    NyquistModulator nyquistDemodulator(nPoints, fft.in);
+    Detector detector(nPoints, prefixSize, &fft, &nyquistDemodulator);
+
+    size_t nData = qam.GetMaxEncodedBytes();
+    ByteVec txBytes(nData);
+
+    // Encode a frame of symbols
+    size_t frameStart = symbolSizeWithPrefx / 2;
+    DoubleVec rxSignal(frameStart + symbolSizeWithPrefx * (nSymbols + 1));
+    for(size_t symbol = 0; symbol < nSymbols; symbol++)
+    {
+        for(size_t i = 0; i < nData; i++)
+        {
+            txBytes[i] = (uint8_t) byteDistribution(generator);
+        }
+        double *dest = &rxSignal[frameStart + symbol*symbolSizeWithPrefx];
+        qam.Modulate(txBytes.data(), (double *) ifft.in, nData);
+        ifft.ComputeTransform( (fftw_complex *) &dest[prefixSize]);
+        nyquistModulator.Modulate(&dest[prefixSize]);
+        AddCyclicPrefix(dest, symbolSize, prefixSize);
+    }
+
+    size_t halfRange = (detector.GetSearchRange()-1) / 2;
+    size_t correlationMisses = 0;
+    long searchTime = 0;
+    // The first symbol follows silence, the rest follow other symbols
+    for(size_t symbol = 1; symbol < nSymbols; symbol++)
+    {
+        size_t expectedStart = frameStart + symbol*symbolSizeWithPrefx;
+
+        size_t prefixStart = 0;
+        auto start = std::chrono::steady_clock::now();
+        detector.SetSearchOffset(expectedStart - halfRange);
+        int status = detector.StreamSearch(rxSignal.data(), 0, rxSignal.size(), prefixStart);
+        auto end = std::chrono::steady_clock::now();
+        searchTime += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+        BOOST_CHECK_MESSAGE( (status == 0 && prefixStart == expectedStart), 
+        "Prefix start of symbol: " << symbol << " detected at: " << prefixStart << " expected: " << expectedStart );
+
+        // Correlation maximum within a prefix length of the start
+        size_t maxIndex = expectedStart - prefixSize;
+        for(size_t i = expectedStart - prefixSize; i < expectedStart + prefixSize; i++)
+        {
+            if(detector.ExecuteCorrelator(rxSignal, i) > detector.ExecuteCorrelator(rxSignal, maxIndex))
+            {
+                maxIndex = i;
+            }
+        }
+        correlationMisses += (maxIndex != expectedStart) ? 1 : 0;
+    }
+
+    std::cout << "Streaming search elapsed time per symbol: " << searchTime / (nSymbols-1) << " ns" << std::endl;
+    std::cout << "Correlation maximum away from the prefix start: " << correlationMisses 
+    << " of " << nSymbols-1 << " symbols" << std::endl;
+}
+
 BOOST_AUTO_TEST_CASE(SymbolStartTest)
 {
     printf("\nTesting Symbol Start Search...\n");
@@ -282,4 +373,326 @@ BOOST_AUTO_TEST_CASE(SymbolStartTest)
         
 }
 
+/**
+* Compares the coarse search, which updates the correlation 
+* incrementally, with a search which computes the full
+* correlation at every offset. A symbol is placed at the end
+* of a 10 symbol buffer so the whole buffer has to be searched.
+* Both searches must return the same prefix start, within one
+* sample of the inserted symbol.
+* 
+*/
+BOOST_AUTO_TEST_CASE(SlidingCorrelatorTest)
+{
+    printf("\nTesting Sliding Correlator...\n");
+
+    size_t nPoints = 512;
+    size_t symbolSize = nPoints*2;
+    size_t prefixSize = symbolSize / 8;
+    size_t symbolSizeWithPrefx = symbolSize + prefixSize;
+    size_t pilotToneStep = 8;
+    double pilotToneAmplitude = 2.0;
+    size_t energyDispersalSeed = 10;
+    size_t bitsPerSymbol = 2;
+
+    // Fixed seed, a payload whose first prefix sample is close to
+    // zero would let the noise decide the peak
+    srand(3);
+
+    // Initialize Encoder objects
+    QamModulator qam(nPoints, pilotToneStep, pilotToneAmplitude, energyDispersalSeed, bitsPerSymbol);
+    ofdmFFT ifft(nPoints, FFTW_BACKWARD, pilotToneStep);
+    NyquistModulator nyquistModulator(nPoints, ifft.out);
+
+    // Initialize Decoder objects
+    ofdmFFT fft(nPoints, FFTW_FORWARD, pilotToneStep);
+    NyquistModulator nyquistDemodulator(nPoints, fft.in);
+    Detector detector(nPoints, prefixSize, &fft, &nyquistDemodulator);
+
+    size_t nData = qam.GetMaxEncodedBytes();
+    ByteVec txBytes(nData);
+    for(size_t i = 0; i < nData; i++)
+    {
+        txBytes[i] = rand() % 255;
+    }
+
+    // Encode one symbol 
+    DoubleVec symbol(symbolSizeWithPrefx);
+    qam.Modulate(txBytes.data(), (double *) ifft.in, nData);
+    ifft.ComputeTransform( (fftw_complex *) &symbol[prefixSize]);
+    nyquistModulator.Modulate(symbol, prefixSize);
+    AddCyclicPrefix(symbol, symbolSize, prefixSize);
+
+    // Low level noise in front of the symbol
+    DoubleVec rxSignal(symbolSizeWithPrefx * 10);
+    for(size_t i = 0; i < rxSignal.size(); i++)
+    {
+        rxSignal[i] = ((double) rand() / RAND_MAX - 0.5) * 0.01;
+    }
+    size_t symbolStart = symbolSizeWithPrefx * 8 + rand() % prefixSize;
+    std::copy(symbol.begin(), symbol.end(), rxSignal.begin() + symbolStart);
+
+    // Full correlation of every offset
+    auto start = std::chrono::steady_clock::now();
+    size_t fullIndex = 0;
+    double maxValue = 0.0;
+    bool thresholdExceeded = false;
+    for(size_t i = 0; i + symbolSize + prefixSize <= rxSignal.size(); i++)
+    {
+        double correlation = detector.ExecuteCorrelator(rxSignal, i);
+        if(correlation >= detector.GetThreshold())
+        {
+            thresholdExceeded = true;
+            if(maxValue <= correlation)
+            {
+                maxValue = correlation;
+                fullIndex = i;
+            }
+        }
+        if((correlation <= detector.GetThreshold()) && thresholdExceeded)
+        {
+            break;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "Full correlation search elapsed time: "
+    << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+    << " ns" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    size_t slidingIndex = detector.CoarseSearch(rxSignal);
+    end = std::chrono::steady_clock::now();
+
+    std::cout << "Sliding correlation search elapsed time: "
+    << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+    << " ns" << std::endl;
+
+    BOOST_CHECK_MESSAGE( (fullIndex == symbolStart), 
+    "Symbol start has not been detected correctly, The peak occurs at index: " << fullIndex );
+    BOOST_CHECK_MESSAGE( (slidingIndex == fullIndex), 
+    "Sliding correlator peak: " << slidingIndex << " differs from full correlation peak: " << fullIndex );
+}
+
+/**
+* Acquires the first symbol of a continuous frame with the
+* stream search and tracks the following symbols. Each tracked
+* start must match the full search and the lock must be lost once the frame ends.
+* Frames with a guard interval between the symbols are tracked
+* with the symbol period set accordingly.
+* 
+*/
+BOOST_AUTO_TEST_CASE(TrackingTest)
+{
+    printf("\nTesting Symbol Timing Tracking...\n");
+
+    size_t nPoints = 512;
+    size_t symbolSize = nPoints*2;
+    size_t prefixSize = symbolSize / 8;
+    size_t symbolSizeWithPrefx = symbolSize + prefixSize;
+    size_t pilotToneStep = 8;
+    double pilotToneAmplitude = 2.0;
+    size_t energyDispersalSeed = 10;
+    size_t bitsPerSymbol = 2;
+    size_t nSymbols = 10;
+
+    // Setup random float generator
+    srand( (unsigned)time( NULL ) );
+
+    // Initialize Encoder objects
+    QamModulator qam(nPoints, pilotToneStep, pilotToneAmplitude, energyDispersalSeed, bitsPerSymbol);
+    ofdmFFT ifft(nPoints, FFTW_BACKWARD, pilotToneStep);
+    NyquistModulator nyquistModulator(nPoints, ifft.out);
+
+    // Initialize Decoder objects
+    ofdmFFT fft(nPoints, FFTW_FORWARD, pilotToneStep);
+    NyquistModulator nyquistDemodulator(nPoints, fft.in);
+    Detector detector(nPoints, prefixSize, &fft, &nyquistDemodulator);
+
+    size_t nData = qam.GetMaxEncodedBytes();
+    ByteVec txBytes(nData);
+
+    for(size_t guardInterval : { (size_t) 0, prefixSize / 2 })
+    {
+        printf("Guard interval: %zu\n", guardInterval);
+        size_t symbolPeriod = symbolSizeWithPrefx + guardInterval;
+        detector.SetSymbolPeriod(symbolPeriod);
+
+        // Encode a frame of symbols at a random position, silence in the guard intervals
+        size_t frameStart = rand() % symbolSizeWithPrefx;
+        DoubleVec rxSignal(frameStart + symbolPeriod * (nSymbols + 2));
+        for(size_t symbol = 0; symbol < nSymbols; symbol++)
+        {
+            for(size_t i = 0; i < nData; i++)
+            {
+                txBytes[i] = rand() % 255;
+            }
+            double *dest = &rxSignal[frameStart + symbol*symbolPeriod];
+            qam.Modulate(txBytes.data(), (double *) ifft.in, nData);
+            ifft.ComputeTransform( (fftw_complex *) &dest[prefixSize]);
+            nyquistModulator.Modulate(&dest[prefixSize]);
+            AddCyclicPrefix(dest, symbolSize, prefixSize);
+        }
+
+        // Acquire as the streaming decoder does, the correlation peak of
+        // back to back symbols may be further off than the fine search range
+        size_t acquiredPrefix = 0;
+        detector.SetSearchOffset(0);
+        BOOST_REQUIRE( detector.StreamSearch(rxSignal.data(), 0, rxSignal.size(), acquiredPrefix) == 0 );
+        size_t symbolStart = detector.FineSearch(rxSignal, acquiredPrefix + prefixSize, nData);
+        BOOST_REQUIRE_MESSAGE( (symbolStart == frameStart + prefixSize), 
+        "Symbol start has not been detected correctly, detected at index: " << symbolStart );
+        detector.Lock(symbolStart);
+
+        size_t halfRange = (detector.GetSearchRange()-1) / 2;
+        long trackingTime = 0;
+        long searchTime = 0;
+        for(size_t symbol = 1; symbol < nSymbols; symbol++)
+        {
+            size_t expectedStart = frameStart + symbol*symbolPeriod + prefixSize;
+
+            auto start = std::chrono::steady_clock::now();
+            int status = detector.TrackSymbolStart(rxSignal.data(), 0, rxSignal.size(), nData, symbolStart);
+            auto end = std::chrono::steady_clock::now();
+            trackingTime += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+            BOOST_CHECK_MESSAGE( (status == 0 && symbolStart == expectedStart), 
+            "Tracking failed at symbol: " << symbol << " status: " << status << " start: " << symbolStart );
+            BOOST_CHECK_MESSAGE( detector.IsLocked(), "Lock lost at symbol: " << symbol );
+
+            // Full search of the same symbol
+            size_t prefixStart = 0;
+            start = std::chrono::steady_clock::now();
+            detector.SetSearchOffset(expectedStart - prefixSize - halfRange);
+            detector.StreamSearch(rxSignal.data(), 0, rxSignal.size(), prefixStart);
+            size_t fineStart = detector.FineSearch(rxSignal, prefixStart + prefixSize, nData);
+            end = std::chrono::steady_clock::now();
+            searchTime += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+            BOOST_CHECK_MESSAGE( (fineStart == expectedStart), 
+            "Full search failed at symbol: " << symbol << " start: " << fineStart );
+        }
+
+        std::cout << "Full search elapsed time per symbol: " << searchTime / (nSymbols-1) << " ns" << std::endl;
+        std::cout << "Tracking elapsed time per symbol: " << trackingTime / (nSymbols-1) << " ns" << std::endl;
+
+        // No symbol follows the frame
+        int status = detector.TrackSymbolStart(rxSignal.data(), 0, rxSignal.size(), nData, symbolStart);
+        BOOST_CHECK_MESSAGE( (status == -1), "Lock has not been lost after the frame, status: " << status );
+        BOOST_CHECK( !detector.IsLocked() );
+    }
+}
+
+/**
+* Computes the pilot tone metric of every offset in the fine search
+* range with full transforms and with the sliding pilot DFT.
+* Both must agree and the lowest metric must be at the symbol start.
+* Real transforms are tested as well.
+* 
+*/
+BOOST_AUTO_TEST_CASE(PilotDFTTest)
+{
+    printf("\nTesting Pilot DFT Fine Search...\n");
+
+    size_t pilotToneStep = 8;
+    double pilotToneAmplitude = 2.0;
+    size_t energyDispersalSeed = 10;
+    size_t bitsPerSymbol = 2;
+    size_t searchRange = 25;
+
+    // Setup random float generator
+    srand( (unsigned)time( NULL ) );
+
+    TransformType transforms[] = { TRANSFORM_COMPLEX, TRANSFORM_REAL };
+    size_t testSizes[] = { 512, 4096 };
+
+    for (TransformType transform : transforms)
+    {
+        for (size_t nPoints : testSizes)
+        {
+            // Initialize Encoder objects
+            bool real = (transform == TRANSFORM_REAL);
+            size_t symbolSize = real ? nPoints : nPoints*2;
+            size_t prefixSize = symbolSize / 8;
+            QamModulator qam(nPoints, pilotToneStep, pilotToneAmplitude, energyDispersalSeed, bitsPerSymbol, real);
+            ofdmFFT ifft(nPoints, FFTW_BACKWARD, pilotToneStep, PLANNER_MEASURE, transform);
+            NyquistModulator nyquistModulator(nPoints, ifft.out);
+
+            // Initialize Decoder objects
+            ofdmFFT fft(nPoints, FFTW_FORWARD, pilotToneStep, PLANNER_MEASURE, transform);
+            NyquistModulator nyquistDemodulator(nPoints, fft.in);
+            PilotDFT pilotDFT(&fft, &nyquistDemodulator, searchRange);
+
+            size_t nData = qam.GetMaxEncodedBytes();
+            ByteVec txBytes(nData);
+            for(size_t i = 0; i < nData; i++)
+            {
+                txBytes[i] = rand() % 255;
+            }
+
+            // Encode one symbol 
+            DoubleVec symbol(symbolSize + prefixSize);
+            qam.Modulate(txBytes.data(), (double *) ifft.in, nData);
+            ifft.ComputeTransform();
+            if(real)
+            {
+                std::copy(ifft.real, ifft.real + nPoints, &symbol[prefixSize]);
+            }
+            else
+            {
+                std::copy((double *) ifft.out, (double *) (ifft.out + nPoints), &symbol[prefixSize]);
+                nyquistModulator.Modulate(&symbol[prefixSize]);
+            }
+            AddCyclicPrefix(symbol.data(), symbolSize, prefixSize);
+
+            DoubleVec rxSignal(symbol.size() * 3);
+            size_t prefixStart = symbol.size() + rand() % symbol.size() / 2;
+            std::copy(symbol.begin(), symbol.end(), rxSignal.begin() + prefixStart);
+            size_t symbolStart = prefixStart + prefixSize;
+            size_t startIndex = symbolStart - (searchRange-1) / 2 + rand() % 5;
+            size_t stopIndex = startIndex + searchRange - 1;
+
+            // Full transform of every candidate
+            DoubleVec metrics(stopIndex - startIndex);
+            auto start = std::chrono::steady_clock::now();
+            for(size_t i = startIndex; i < stopIndex; i++)
+            {
+                if(real)
+                {
+                    std::copy(&rxSignal[i], &rxSignal[i + symbolSize], fft.real);
+                }
+                else
+                {
+                    nyquistDemodulator.Demodulate(rxSignal.data(), i);
+                }
+                fft.ComputeTransform();
+                fft.Normalise();
+                metrics[i - startIndex] = std::abs(fft.GetImagSum(nData));
+            }
+            auto end = std::chrono::steady_clock::now();
+
+            std::cout << "nPoints = " << nPoints << (real ? " Real" : " Complex") << " Full transform search elapsed time: "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+            << " ns" << std::endl;
+
+            pilotDFT.SetPilots(fft.GetLayout(nData).GetPilotIndices());
+            start = std::chrono::steady_clock::now();
+            size_t fineIndex = pilotDFT.Search(rxSignal.data(), startIndex, stopIndex);
+            end = std::chrono::steady_clock::now();
+
+            std::cout << "nPoints = " << nPoints << (real ? " Real" : " Complex") << " Pilot DFT search elapsed time: "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+            << " ns" << std::endl;
+
+            BOOST_CHECK_MESSAGE( (fineIndex == symbolStart), 
+            "Symbol start has not been detected correctly, The lowest metric occurs at index: " << fineIndex );
+            for(size_t i = startIndex; i < stopIndex; i++)
+            {
+                BOOST_CHECK_MESSAGE( (std::abs(pilotDFT.GetMetric(i) - metrics[i - startIndex]) <= 1e-6 * (1.0 + metrics[i - startIndex])),
+                "Metrics differ at offset: " << i << " Pilot DFT: " << pilotDFT.GetMetric(i) << " Full transform: " << metrics[i - startIndex] );
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
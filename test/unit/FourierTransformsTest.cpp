@@ -14,6 +14,10 @@
 // For Random Float Generator
 #include <time.h>
 
+// For concurrent plan cache use
+#include <thread>
+#include <atomic>
+
 // For object under test
 #include "ofdmfft.h"
 
@@ -518,4 +522,297 @@ BOOST_AUTO_TEST_CASE(Reconfiguration)
     }
     fftw_cleanup();
 }
+
+/**
+* Plan a transform, export the wisdom and forget it.
+* Measure the construction time without and with imported 
+* wisdom, then check a plan created from wisdom only 
+* computes the same transform as a measured plan.
+* 
+*/
+BOOST_AUTO_TEST_CASE(Wisdom)
+{
+    printf("\nTesting Wisdom Import & Export...\n");
+
+    // Setup random float generator
+    srand( (unsigned)time( NULL ) );
+
+    size_t nPoints = 4096;
+    uint16_t pilotToneStep = 16;
+
+    // Garbage must be rejected
+    BOOST_CHECK_MESSAGE( (ofdmFFT::ImportWisdomString("not wisdom") != 0), "Invalid wisdom has been imported");
+
+    ofdmFFT::ForgetWisdom();
+    auto start = std::chrono::steady_clock::now();
+    ofdmFFT measuredfft(nPoints, FFTW_FORWARD, pilotToneStep, PLANNER_MEASURE);
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "Construction without wisdom elapsed time: "
+        << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+        << " ns" << std::endl;
+
+    std::string wisdom = ofdmFFT::ExportWisdomString();
+    BOOST_REQUIRE_MESSAGE( (!wisdom.empty()), "No wisdom has been exported");
+
+    // Start again with the exported wisdom only
+    ofdmFFT::ForgetWisdom();
+    BOOST_REQUIRE_MESSAGE( (ofdmFFT::ImportWisdomString(wisdom) == 0), "Exported wisdom could not be imported");
+
+    start = std::chrono::steady_clock::now();
+    ofdmFFT wisdomfft(nPoints, FFTW_FORWARD, pilotToneStep, PLANNER_WISDOM_ONLY);
+    end = std::chrono::steady_clock::now();
+
+    std::cout << "Construction with wisdom elapsed time: "
+        << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+        << " ns" << std::endl;
+
+    // Generate random floats
+    for (size_t i = 0; i < nPoints; i++)
+    {
+        measuredfft.in[i][0] = wisdomfft.in[i][0] = (double) rand()/RAND_MAX;
+        measuredfft.in[i][1] = wisdomfft.in[i][1] = (double) rand()/RAND_MAX;
+    }
+    measuredfft.ComputeTransform();
+    wisdomfft.ComputeTransform();
+
+    for (size_t i = 0; i < nPoints; i++)
+    {
+        BOOST_CHECK_MESSAGE(
+        ( (std::abs( measuredfft.out[i][0] - wisdomfft.out[i][0] ) <= FFT_NUMERICAL_THRESHOLD ) &&
+        (  std::abs( measuredfft.out[i][1] - wisdomfft.out[i][1] ) <= FFT_NUMERICAL_THRESHOLD )), 
+        "Values vary more than threshold! - Occured at: Index i = " << i );  
+    }
+    ofdmFFT::ForgetWisdom();
+}
+
+/**
+* Transforms random data with the forward and backward 
+* objects and counts the points which are not recovered.
+* 
+*/
+static size_t CountRoundTripErrors(ofdmFFT &forwardfft, ofdmFFT &backwardfft, size_t nPoints, unsigned int *seed)
+{
+    size_t nErrors = 0;
+    for (size_t i = 0; i < nPoints; i++)
+    {
+        forwardfft.in[i][0] = (double) rand_r(seed)/RAND_MAX;
+        forwardfft.in[i][1] = (double) rand_r(seed)/RAND_MAX;
+    }
+    forwardfft.ComputeTransform();
+    std::copy((double *) forwardfft.out, (double *) (forwardfft.out + nPoints), (double *) backwardfft.in);
+    backwardfft.ComputeTransform();
+    backwardfft.Normalise();
+    for (size_t i = 0; i < nPoints; i++)
+    {
+        if( (std::abs( forwardfft.in[i][0] - backwardfft.out[i][0] ) > FFT_NUMERICAL_THRESHOLD ) ||
+            (std::abs( forwardfft.in[i][1] - backwardfft.out[i][1] ) > FFT_NUMERICAL_THRESHOLD ) )
+        {
+            nErrors++;
+        }
+    }
+    return nErrors;
+}
+
+
+/**
+* Objects of the same size and direction must share one plan,
+* which remains valid until the last of them is closed. 
+* Then many threads configure and execute objects of the same
+* size concurrently.
+* 
+*/
+BOOST_AUTO_TEST_CASE(PlanCache)
+{
+    printf("\nTesting Plan Cache...\n");
+
+    size_t nPoints = 1024;
+    uint16_t pilotToneStep = 16;
+    unsigned int seed = (unsigned) time( NULL );
+    size_t nCached = FFTPlanCache::GetSize();
+
+    ofdmFFT firstfft(nPoints, FFTW_FORWARD, pilotToneStep);
+    auto start = std::chrono::steady_clock::now();
+    ofdmFFT forwardfft(nPoints, FFTW_FORWARD, pilotToneStep);
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "Construction with cached plan elapsed time: "
+        << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+        << " ns" << std::endl;
+
+    // Forward objects also hold the plan reading unaligned samples
+    ofdmFFT backwardfft(nPoints, FFTW_BACKWARD, pilotToneStep);
+    BOOST_CHECK_MESSAGE( (FFTPlanCache::GetSize() == nCached + 3), "Plans have not been shared, cache size: " << FFTPlanCache::GetSize());
+
+    // The shared plan must survive closing one of its users
+    firstfft.Close();
+    BOOST_CHECK_MESSAGE( (FFTPlanCache::GetSize() == nCached + 3), "Shared plan has been destroyed");
+    BOOST_CHECK_MESSAGE( (CountRoundTripErrors(forwardfft, backwardfft, nPoints, &seed) == 0), "Values vary more than threshold after closing a plan user");
+
+    size_t nThreads = 8;
+    size_t nIterations = 50;
+    std::atomic<size_t> nErrors(0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < nThreads; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            unsigned int threadSeed = seed + t;
+            for (size_t i = 0; i < nIterations; i++)
+            {
+                ofdmFFT threadForward(nPoints, FFTW_FORWARD, pilotToneStep);
+                ofdmFFT threadBackward(nPoints, FFTW_BACKWARD, pilotToneStep);
+                nErrors += CountRoundTripErrors(threadForward, threadBackward, nPoints, &threadSeed);
+            }
+        });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    BOOST_CHECK_MESSAGE( (nErrors == 0), "Concurrent transforms differ in " << nErrors << " points");
+    BOOST_CHECK_MESSAGE( (FFTPlanCache::GetSize() == nCached + 3), "Plans have not been released, cache size: " << FFTPlanCache::GetSize());
+
+    forwardfft.Close();
+    backwardfft.Close();
+    BOOST_CHECK_MESSAGE( (FFTPlanCache::GetSize() == nCached), "Plans have not been destroyed, cache size: " << FFTPlanCache::GetSize());
+}
+
+/**
+* Generate random Hermitian spectrum, put it through the inverse
+* real transform and back through the forward real transform.
+* The elapsed times are compared with the complex transform
+* producing the same number of real samples.
+* 
+*/
+BOOST_AUTO_TEST_CASE(RealTransform)
+{
+    printf("\nTesting Real Transform...\n");
+
+    // Setup random float generator
+    srand( (unsigned)time( NULL ) );
+
+    uint16_t pilotToneStep = 16;
+    size_t testSizes[] = { 1024, 8192 };
+
+    for (size_t nPoints : testSizes)
+    {
+        printf("\nTesting %lu Point Real FFT\n", nPoints);
+        ofdmFFT backwardfft(nPoints, FFTW_BACKWARD, pilotToneStep, PLANNER_MEASURE, TRANSFORM_REAL);
+        ofdmFFT forwardfft(nPoints, FFTW_FORWARD, pilotToneStep, PLANNER_MEASURE, TRANSFORM_REAL);
+        // Complex transform of half the size yields the same number of samples
+        ofdmFFT complexfft(nPoints/2, FFTW_BACKWARD, pilotToneStep);
+
+        size_t nCoefficients = backwardfft.GetSpectrumSize();
+        BOOST_REQUIRE_MESSAGE( (nCoefficients == nPoints/2 + 1), "Unexpected spectrum size: " << nCoefficients );
+
+        DoubleVec spectrum(nCoefficients*2, 0.0);
+        // DC and Nyquist frequency are real
+        for (size_t i = 1; i < nCoefficients - 1; i++)
+        {
+            spectrum[i*2] = (double) rand()/RAND_MAX;
+            spectrum[i*2+1] = (double) rand()/RAND_MAX;
+        }
+        std::copy(spectrum.begin(), spectrum.end(), (double *) backwardfft.in);
+
+        auto start = std::chrono::steady_clock::now();
+        backwardfft.ComputeTransform();
+        auto end = std::chrono::steady_clock::now();
+
+        std::cout << "Inverse real transform elapsed time: "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+            << " ns" << std::endl;
+
+        start = std::chrono::steady_clock::now();
+        complexfft.ComputeTransform();
+        end = std::chrono::steady_clock::now();
+
+        std::cout << "Inverse complex transform elapsed time: "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+            << " ns" << std::endl;
+
+        std::copy(backwardfft.real, backwardfft.real + nPoints, forwardfft.real);
+        forwardfft.ComputeTransform();
+        forwardfft.Normalise();
+
+        for (size_t i = 0; i < nCoefficients; i++)
+        {
+            BOOST_CHECK_MESSAGE(
+            ( (std::abs( spectrum[i*2] - forwardfft.out[i][0] ) <= FFT_NUMERICAL_THRESHOLD ) &&
+            (  std::abs( spectrum[i*2+1] - forwardfft.out[i][1] ) <= FFT_NUMERICAL_THRESHOLD )), 
+            "Values vary more than threshold! - Occured at: Index i = " << i );  
+        }
+    }
+}
+
+/**
+* Transforms read straight from a sample buffer at aligned and
+* unaligned offsets must match the transforms of the samples
+* copied into the input buffer. The samples must not change.
+* 
+*/
+BOOST_AUTO_TEST_CASE(TransformFromSamples)
+{
+    printf("\nTesting Transform From Samples...\n");
+
+    // Setup random float generator
+    srand( (unsigned)time( NULL ) );
+
+    uint16_t pilotToneStep = 16;
+    size_t nPoints = 1024;
+
+    for (TransformType transform : { TRANSFORM_COMPLEX, TRANSFORM_REAL })
+    {
+        ofdmFFT forwardfft(nPoints, FFTW_FORWARD, pilotToneStep, PLANNER_MEASURE, transform);
+        size_t nSamples = (transform == TRANSFORM_REAL) ? nPoints : nPoints*2;
+        size_t nCoefficients = forwardfft.GetSpectrumSize();
+
+        double *samples = (double *) fftw_malloc(sizeof(double) * (nSamples + 3));
+        for (size_t i = 0; i < nSamples + 3; i++)
+        {
+            samples[i] = (double) rand()/RAND_MAX;
+        }
+        DoubleVec original(samples, samples + nSamples + 3);
+
+        for (size_t offset = 0; offset < 4; offset++)
+        {
+            // Reference copies the samples into the input buffer
+            double *input = (transform == TRANSFORM_REAL) ? forwardfft.real : (double *) forwardfft.in;
+            std::copy(&samples[offset], &samples[offset + nSamples], input);
+            auto start = std::chrono::steady_clock::now();
+            forwardfft.ComputeTransform();
+            auto end = std::chrono::steady_clock::now();
+            DoubleVec expected((double *) forwardfft.out, (double *) (forwardfft.out + nCoefficients));
+
+            std::cout << "Offset " << offset << ", Transform of the input buffer elapsed time: "
+                << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+                << " ns" << std::endl;
+
+            std::fill(input, input + nSamples, 0.0);
+            start = std::chrono::steady_clock::now();
+            BOOST_REQUIRE( forwardfft.ComputeTransform(&samples[offset]) == 0 );
+            end = std::chrono::steady_clock::now();
+
+            std::cout << "Offset " << offset << ", Transform of the samples elapsed time: "
+                << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+                << " ns" << std::endl;
+
+            for (size_t i = 0; i < nCoefficients; i++)
+            {
+                BOOST_CHECK_MESSAGE(
+                ( (std::abs( expected[i*2] - forwardfft.out[i][0] ) <= FFT_NUMERICAL_THRESHOLD ) &&
+                (  std::abs( expected[i*2+1] - forwardfft.out[i][1] ) <= FFT_NUMERICAL_THRESHOLD )), 
+                "Values vary more than threshold! - Offset: " << offset << " Index i = " << i );  
+            }
+            BOOST_CHECK_MESSAGE( std::equal(original.begin(), original.end(), samples), "Samples have been modified - Offset: " << offset );
+        }
+        fftw_free(samples);
+    }
+
+    // Inverse transforms have no plan reading samples
+    ofdmFFT backwardfft(nPoints, FFTW_BACKWARD, pilotToneStep);
+    DoubleVec samples(nPoints*2, 0.0);
+    BOOST_CHECK( backwardfft.ComputeTransform(samples.data()) == -1 );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
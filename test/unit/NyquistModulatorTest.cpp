@@ -7,6 +7,7 @@
 #include <cmath> 
 #include <iostream>
 #include <unistd.h>
+#include <cstring>
 
 // For measuring elapsed time
 #include <chrono>
@@ -16,6 +17,7 @@
 
 // For object under test
 #include "nyquist-modulator.h"
+#include "nyquist-kernels.h"
 #include "fftw3.h"
 
 #define DIFFERENCE_THRESHOLD 0.0001
@@ -123,4 +125,105 @@ BOOST_AUTO_TEST_CASE(ModToDemod)
     }
 }
 
+
+/**
+* Runs the modulator and demodulator with each kernel set on
+* even and odd transform sizes and checks the output is bit
+* exact with the reference +1 / -1 multiplier loop. Prints the
+* elapsed time of each kernel.
+* 
+*/
+BOOST_AUTO_TEST_CASE(NyquistKernelsToLoop)
+{
+    printf("\nTesting Nyquist Modulator Kernels...\n");
+
+    size_t nRepeats = 100;
+    const char *names[] = { "Scalar", "SSE2", "AVX" };
+    NyquistKernelSet defaultSet = NyquistKernels::GetKernelSet();
+
+    // Setup random float generator
+    srand( (unsigned)time( NULL ) );
+
+    for(size_t nPoints : {8192, 1024, 1023, 6, 5, 1})
+    {
+        size_t symbolSize = nPoints*2;
+        size_t offset = rand() % 16;
+
+        DoubleVec ifftOutput(symbolSize);
+        for (size_t i = 0; i < symbolSize; i++)
+        {
+            ifftOutput[i] = (double) rand()/RAND_MAX - 0.5;
+        }
+
+        // Reference loop
+        DoubleVec expected(symbolSize);
+        double s = 1.0;
+        auto start = std::chrono::steady_clock::now();
+        for(size_t repeat = 0; repeat < nRepeats; repeat++)
+        {
+            s = 1.0;
+            for(size_t i = 0; i < nPoints; i++)
+            {
+                expected[i*2] = s * ifftOutput[i*2];
+                expected[i*2+1] = s * ifftOutput[i*2+1];
+                s = -s;
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        double loopTime = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / (double) nRepeats;
+
+        std::cout << "nPoints = " << nPoints << ", Loop elapsed time: " << loopTime << " ns" << std::endl;
+
+        fftw_complex *demodulatorOutput = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * nPoints);
+        for(NyquistKernelSet kernelSet : { NYQUIST_KERNEL_SCALAR, NYQUIST_KERNEL_SSE2, NYQUIST_KERNEL_AVX })
+        {
+            if(NyquistKernels::SetKernelSet(kernelSet) != 0)
+            {
+                std::cout << names[kernelSet] << " kernels not supported" << std::endl;
+                continue;
+            }
+            NyquistModulator modulator(nPoints, nullptr);
+            NyquistModulator demodulator(nPoints, demodulatorOutput);
+
+            // In place modulation after a prefix
+            DoubleVec modulatorOutput(offset + symbolSize);
+            std::copy(ifftOutput.begin(), ifftOutput.end(), modulatorOutput.begin()+offset);
+            start = std::chrono::steady_clock::now();
+            modulator.Modulate(modulatorOutput, offset);
+            end = std::chrono::steady_clock::now();
+            double modulateTime = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+            // Copying modulation from the complex IFFT output
+            DoubleVec copiedOutput(symbolSize);
+            start = std::chrono::steady_clock::now();
+            for(size_t repeat = 0; repeat < nRepeats; repeat++)
+            {
+                modulator.Modulate( (const fftw_complex *) ifftOutput.data(), copiedOutput.data());
+            }
+            end = std::chrono::steady_clock::now();
+            double copyTime = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / (double) nRepeats;
+
+            start = std::chrono::steady_clock::now();
+            for(size_t repeat = 0; repeat < nRepeats; repeat++)
+            {
+                demodulator.Demodulate(modulatorOutput.data(), offset);
+            }
+            end = std::chrono::steady_clock::now();
+            double demodulateTime = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / (double) nRepeats;
+
+            std::cout << "nPoints = " << nPoints << ", " << names[kernelSet] << " in place modulate elapsed time: " << modulateTime 
+            << " ns, modulate elapsed time: " << copyTime << " ns, demodulate elapsed time: " << demodulateTime << " ns" << std::endl;
+
+            BOOST_CHECK_MESSAGE( (std::memcmp(&modulatorOutput[offset], expected.data(), symbolSize*sizeof(double)) == 0),
+            names[kernelSet] << " in place modulation differs! - nPoints: " << nPoints );
+            BOOST_CHECK_MESSAGE( (std::memcmp(copiedOutput.data(), expected.data(), symbolSize*sizeof(double)) == 0),
+            names[kernelSet] << " modulation differs! - nPoints: " << nPoints );
+            BOOST_CHECK_MESSAGE( (std::memcmp(demodulatorOutput, ifftOutput.data(), symbolSize*sizeof(double)) == 0),
+            names[kernelSet] << " demodulation differs! - nPoints: " << nPoints );
+        }
+        fftw_free(demodulatorOutput);
+    }
+    NyquistKernels::SetKernelSet(defaultSet);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
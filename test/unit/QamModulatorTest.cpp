@@ -9,6 +9,8 @@
 #include <iostream>
 #include <unistd.h>
 #include <vector>
+#include <algorithm>
+#include <complex>
 
 // For measuring elapsed time
 #include <chrono>
@@ -16,8 +18,17 @@
 // For Random Float Generator
 #include <time.h>
 
+// For concurrent modulators
+#include <thread>
+#include <random>
+#include <bitset>
+
 // For object under test
 #include "qam-modulator.h"
+#include "energy-dispersal.h"
+#include "subcarrier-layout.h"
+#include "qam-kernels.h"
+#include "channel-estimator.h"
 #include "common.h"
 #include "fftw3.h"
 
@@ -91,4 +102,781 @@ BOOST_AUTO_TEST_CASE(QamModToDemod)
 
 }
 
+/**
+* Generate random data execute QAM Modulator and demodulator
+* on the Hermitian spectrum of a real transform.
+* 
+*/
+BOOST_AUTO_TEST_CASE(HermitianModToDemod)
+{
+    printf("\nTesting Hermitian QAM Modulation to Demodulation...\n");
+
+    size_t nPoints = 1024;
+    size_t pilotToneStep = 8;
+    size_t energyDispersalSeed = 10;
+    size_t bitsPerSymbol = 2;
+    double pilotToneAmplitude = 2.0;
+
+    // Setup random float generator
+    srand( (unsigned)time( NULL ) );
+
+    QamModulator qam(nPoints, pilotToneStep, pilotToneAmplitude, energyDispersalSeed, bitsPerSymbol, true);
+    size_t nData = qam.GetMaxEncodedBytes();
+
+    std::vector<unsigned char> TxCharArray(nData);
+    std::vector<unsigned char> RxCharArray(nData);
+    for(size_t i = 0; i < nData; i++ )
+    {
+        TxCharArray[i] = (unsigned char) rand() % 255;
+    }
+
+    // Only non negative frequencies are held
+    DoubleVec QamOutput((nPoints/2 + 1)*2, 5.0);
+
+    auto start = std::chrono::steady_clock::now();
+    qam.Modulate(TxCharArray, QamOutput, nData);
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "Hermitian QAM Modulator elapsed time: "
+    << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+    << " ns" << std::endl;
+
+    // DC and Nyquist frequency must be empty, pilots real
+    BOOST_CHECK_MESSAGE( (QamOutput[0] == 0.0 && QamOutput[1] == 0.0), "DC has been set" );
+    BOOST_CHECK_MESSAGE( (QamOutput[nPoints] == 0.0 && QamOutput[nPoints+1] == 0.0), "Nyquist frequency has been set" );
+    for(size_t i = pilotToneStep; i < nPoints/2; i += pilotToneStep)
+    {
+        BOOST_CHECK_MESSAGE( (QamOutput[i*2] == pilotToneAmplitude && QamOutput[i*2+1] == 0.0), 
+        "Pilot tone missing at point: " << i );
+    }
+
+    qam.Demodulate(QamOutput, RxCharArray, nData);
+    for(size_t i = 0; i < nData; i++)
+    {
+        BOOST_CHECK_MESSAGE( (TxCharArray[i] == RxCharArray[i] ), 
+        "Elements differ! - Occured at index: " << i );
+    }
+}
+
+/**
+* Checks the scrambling sequence against the start of the 
+* DVB sequence and that scrambling twice restores the data,
+* for lengths which are not a multiple of the word size.
+* 
+*/
+BOOST_AUTO_TEST_CASE(EnergyDispersalSequence)
+{
+    printf("\nTesting Energy Dispersal...\n");
+
+    // DVB initialisation word, seed 0
+    EnergyDispersal dvb(0, 4);
+    uint8_t expected[4] = { 0x03, 0xF6, 0x08, 0x34 };
+    for(size_t i = 0; i < 4; i++)
+    {
+        BOOST_CHECK_MESSAGE( (dvb.GetSequence()[i] == expected[i]), 
+        "Sequence differs at index: " << i << " value: " << (int) dvb.GetSequence()[i] );
+    }
+
+    // Setup random float generator
+    srand( (unsigned)time( NULL ) );
+
+    size_t nBytes = 1021;
+    EnergyDispersal dispersal(10, nBytes);
+    ByteVec data(nBytes);
+    for(size_t i = 0; i < nBytes; i++)
+    {
+        data[i] = rand() % 255;
+    }
+    ByteVec scrambled(nBytes);
+    auto start = std::chrono::steady_clock::now();
+    dispersal.Apply(data.data(), scrambled.data(), nBytes);
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "Energy dispersal of " << nBytes << " bytes elapsed time: "
+    << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+    << " ns" << std::endl;
+
+    // In place descrambling
+    dispersal.Apply(scrambled.data(), scrambled.data(), nBytes);
+    for(size_t i = 0; i < nBytes; i++)
+    {
+        BOOST_CHECK_MESSAGE( (data[i] == scrambled[i]), "Elements differ! - Occured at index: " << i );
+    }
+}
+
+
+/**
+* Runs modulators with different seeds on several threads at
+* once. Each has its own scrambling sequence, so the data of 
+* every thread must be recovered.
+* 
+*/
+BOOST_AUTO_TEST_CASE(ConcurrentModToDemod)
+{
+    printf("\nTesting Concurrent QAM Modulation to Demodulation...\n");
+
+    size_t nPoints = 1024;
+    size_t pilotToneStep = 8;
+    size_t bitsPerSymbol = 2;
+    double pilotToneAmplitude = 2.0;
+    size_t nThreads = 4;
+    size_t nSymbols = 200;
+
+    std::vector<size_t> nErrors(nThreads, 0);
+    std::vector<std::thread> threads;
+    for(size_t t = 0; t < nThreads; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            QamModulator qam(nPoints, pilotToneStep, pilotToneAmplitude, t + 1, bitsPerSymbol);
+            size_t nData = qam.GetMaxEncodedBytes();
+            ByteVec tx(nData);
+            ByteVec rx(nData);
+            DoubleVec points(nPoints*2);
+            for(size_t symbol = 0; symbol < nSymbols; symbol++)
+            {
+                for(size_t i = 0; i < nData; i++)
+                {
+                    tx[i] = (uint8_t) (i * 31 + symbol * 7 + t);
+                }
+                qam.Modulate(tx, points, nData);
+                qam.Demodulate(points, rx, nData);
+                if(tx != rx)
+                {
+                    nErrors[t]++;
+                }
+            }
+        });
+    }
+    for(std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    for(size_t t = 0; t < nThreads; t++)
+    {
+        BOOST_CHECK_MESSAGE( (nErrors[t] == 0), "Thread: " << t << " failed to recover " << nErrors[t] << " symbols" );
+    }
+}
+
+/**
+* Checks that the data points and pilot tones of the layouts
+* of full and partial symbols are distinct points within the
+* spectrum, and that Hermitian layouts leave DC and the Nyquist
+* frequency empty.
+* 
+*/
+BOOST_AUTO_TEST_CASE(SubcarrierLayoutIndices)
+{
+    printf("\nTesting Subcarrier Layout...\n");
+
+    size_t nPoints = 1024;
+    size_t pilotToneStep = 8;
+
+    for(bool hermitian : { false, true })
+    {
+        SubcarrierLayout layout(nPoints, pilotToneStep, hermitian);
+        size_t nMaxDataPoints = layout.GetMaxDataPoints();
+        size_t nUsedPoints = hermitian ? nPoints/2 + 1 : nPoints;
+        for(size_t nDataPoints : { nMaxDataPoints, nMaxDataPoints / 2 })
+        {
+            BOOST_REQUIRE( layout.Update(nDataPoints) == 0 );
+            const std::vector<size_t> &data = layout.GetDataIndices();
+            const std::vector<size_t> &pilots = layout.GetPilotIndices();
+            BOOST_CHECK_MESSAGE( (data.size() == nDataPoints), "Unexpected number of data points: " << data.size() );
+
+            std::vector<int> used(nUsedPoints, 0);
+            for(size_t index : data)
+            {
+                BOOST_REQUIRE( index < nUsedPoints );
+                used[index]++;
+            }
+            for(size_t index : pilots)
+            {
+                BOOST_REQUIRE( index < nUsedPoints );
+                used[index]++;
+            }
+            for(size_t i = 0; i < nUsedPoints; i++)
+            {
+                BOOST_CHECK_MESSAGE( (used[i] <= 1), "Point used more than once: " << i );
+            }
+            if(hermitian)
+            {
+                BOOST_CHECK_MESSAGE( (used[0] == 0 && used[nPoints/2] == 0), "DC or Nyquist frequency has been used" );
+            }
+        }
+        BOOST_CHECK( layout.Update(nMaxDataPoints + 1) == -1 );
+    }
+}
+
+/**
+* Modulates and demodulates random data with 16, 64 and 256-QAM
+* on both layouts, for full and partial symbols. Noise smaller than
+* half of the level spacing must not change the decoded data and
+* the average energy of a point must equal that of 4-QAM.
+* 
+*/
+BOOST_AUTO_TEST_CASE(HigherOrderModToDemod)
+{
+    printf("\nTesting Higher Order QAM Modulation to Demodulation...\n");
+
+    size_t nPoints = 1024;
+    size_t pilotToneStep = 8;
+    size_t energyDispersalSeed = 10;
+    double pilotToneAmplitude = 2.0;
+
+    // Setup random float generator
+    srand( (unsigned)time( NULL ) );
+
+    for(size_t bitsPerSymbol : { 4, 6, 8 })
+    {
+        for(bool hermitian : { false, true })
+        {
+            QamModulator qam(nPoints, pilotToneStep, pilotToneAmplitude, energyDispersalSeed, bitsPerSymbol, hermitian);
+            SubcarrierLayout layout(nPoints, pilotToneStep, hermitian);
+            size_t nMaxData = qam.GetMaxEncodedBytes();
+            BOOST_CHECK_MESSAGE( (nMaxData == layout.GetMaxDataPoints() * bitsPerSymbol / 8), 
+            "Unexpected capacity: " << nMaxData << " bits per point: " << bitsPerSymbol );
+
+            for(size_t nData : { nMaxData, nMaxData - 3 })
+            {
+                ByteVec tx(nData);
+                ByteVec rx(nData);
+                for(size_t i = 0; i < nData; i++)
+                {
+                    tx[i] = rand() % 256;
+                }
+                DoubleVec points(nPoints*2, 0.0);
+
+                auto start = std::chrono::steady_clock::now();
+                qam.Modulate(tx, points, nData);
+                auto end = std::chrono::steady_clock::now();
+                double modulateTime = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+                // Average energy of the data points
+                layout.Update(qam.GetDataPoints(nData));
+                double energy = 0.0;
+                for(size_t index : layout.GetDataIndices())
+                {
+                    energy += points[index*2]*points[index*2] + points[index*2+1]*points[index*2+1];
+                }
+                energy /= layout.GetDataIndices().size();
+                BOOST_CHECK_MESSAGE( (std::abs(energy - 2.0) < 0.25), 
+                "Unexpected average energy: " << energy << " bits per point: " << bitsPerSymbol );
+
+                // Noise below half of the level spacing
+                double levelScale = sqrt(3.0 / (double) ((1 << bitsPerSymbol) - 1));
+                for(size_t index : layout.GetDataIndices())
+                {
+                    points[index*2] += levelScale * (((double) rand() / RAND_MAX) - 0.5) * 1.8;
+                    points[index*2+1] += levelScale * (((double) rand() / RAND_MAX) - 0.5) * 1.8;
+                }
+
+                start = std::chrono::steady_clock::now();
+                qam.Demodulate(points, rx, nData);
+                end = std::chrono::steady_clock::now();
+
+                std::cout << (1 << bitsPerSymbol) << "-QAM" << (hermitian ? " Hermitian" : "") << " " << nData 
+                << " bytes, Modulator elapsed time: " << modulateTime << " ns, Demodulator elapsed time: "
+                << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+                << " ns" << std::endl;
+
+                for(size_t i = 0; i < nData; i++)
+                {
+                    BOOST_CHECK_MESSAGE( (tx[i] == rx[i]), 
+                    "Elements differ! - Occured at index: " << i << " bits per point: " << bitsPerSymbol );
+                }
+            }
+        }
+    }
+}
+
+/**
+* Compares every 4-QAM kernel supported by the CPU against the 
+* per bit loops the modulator used before, both the mapping of
+* bytes onto points and the packing of hard decisions into bytes, 
+* and prints the elapsed time of each.
+* 
+*/
+BOOST_AUTO_TEST_CASE(QamKernelsToLoops)
+{
+    printf("\nTesting 4-QAM Kernels...\n");
+
+    size_t nBytes = 4096;
+    size_t nRepeats = 100;
+    const char *names[] = { "Scalar", "SSE4", "AVX2" };
+    QamKernelSet defaultSet = QamKernels::GetKernelSet();
+
+    // Setup random float generator
+    srand( (unsigned)time( NULL ) );
+
+    ByteVec data(nBytes);
+    for(size_t i = 0; i < nBytes; i++)
+    {
+        data[i] = rand() % 256;
+    }
+
+    // Reference per bit loops
+    DoubleVec expectedPoints(nBytes*8);
+    ByteVec expectedData(nBytes);
+    auto start = std::chrono::steady_clock::now();
+    for(size_t repeat = 0; repeat < nRepeats; repeat++)
+    {
+        for(size_t byteCounter = 0; byteCounter < nBytes; byteCounter++)
+        {
+            uint8_t dataByte = data[byteCounter];
+            for(size_t i = 0; i < 4; i++)
+            {
+                expectedPoints[byteCounter*8+i*2] = (double) (((dataByte >> (i*2)) & 0x01) * 2) - 1.0;
+                expectedPoints[byteCounter*8+i*2+1] = (double) (((dataByte >> (i*2+1)) & 0x01) * 2) - 1.0;
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double loopMapTime = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / (double) nRepeats;
+
+    start = std::chrono::steady_clock::now();
+    for(size_t repeat = 0; repeat < nRepeats; repeat++)
+    {
+        for(size_t byteCounter = 0; byteCounter < nBytes; byteCounter++)
+        {
+            uint8_t dataByte = 0;
+            for(size_t i = 0; i < 4; i++)
+            {
+                dataByte |= (uint8_t) ((expectedPoints[byteCounter*8+i*2] > 0) << (i*2));
+                dataByte |= (uint8_t) ((expectedPoints[byteCounter*8+i*2+1] > 0) << (i*2+1));
+            }
+            expectedData[byteCounter] = dataByte;
+        }
+    }
+    end = std::chrono::steady_clock::now();
+    double loopPackTime = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / (double) nRepeats;
+    BOOST_REQUIRE( expectedData == data );
+
+    std::cout << nBytes << " bytes, Loop map elapsed time: " << loopMapTime 
+    << " ns, pack elapsed time: " << loopPackTime << " ns" << std::endl;
+
+    for(QamKernelSet kernelSet : { QAM_KERNEL_SCALAR, QAM_KERNEL_SSE4, QAM_KERNEL_AVX2 })
+    {
+        if(QamKernels::SetKernelSet(kernelSet) != 0)
+        {
+            std::cout << names[kernelSet] << " kernels not supported" << std::endl;
+            continue;
+        }
+        DoubleVec points(nBytes*8);
+        ByteVec packed(nBytes);
+        start = std::chrono::steady_clock::now();
+        for(size_t repeat = 0; repeat < nRepeats; repeat++)
+        {
+            QamKernels::MapBits(data.data(), points.data(), nBytes);
+        }
+        end = std::chrono::steady_clock::now();
+        double mapTime = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / (double) nRepeats;
+
+        // Zero must decode as a cleared bit
+        points[0] = 0.0;
+        points[1] = -0.0;
+        start = std::chrono::steady_clock::now();
+        for(size_t repeat = 0; repeat < nRepeats; repeat++)
+        {
+            QamKernels::PackBits(points.data(), packed.data(), nBytes);
+        }
+        end = std::chrono::steady_clock::now();
+        double packTime = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / (double) nRepeats;
+
+        std::cout << nBytes << " bytes, " << names[kernelSet] << " map elapsed time: " << mapTime 
+        << " ns, pack elapsed time: " << packTime << " ns" << std::endl;
+
+        for(size_t i = 2; i < nBytes*8; i++)
+        {
+            BOOST_CHECK_MESSAGE( (points[i] == expectedPoints[i]), 
+            names[kernelSet] << " points differ! - Occured at index: " << i );
+        }
+        BOOST_CHECK_MESSAGE( (packed[0] == (data[0] & 0xFC)), names[kernelSet] << " zero decoded as set bit" );
+        for(size_t i = 1; i < nBytes; i++)
+        {
+            BOOST_CHECK_MESSAGE( (packed[i] == data[i]), 
+            names[kernelSet] << " bytes differ! - Occured at index: " << i );
+        }
+
+        // Lengths which are not a multiple of the bytes per iteration
+        for(size_t nTail : { 1, 2, 3, 5, 6, 7 })
+        {
+            DoubleVec tailPoints(nTail*8 + 1, 2.0);
+            ByteVec tailPacked(nTail + 1, 0xA5);
+            QamKernels::MapBits(&data[1], tailPoints.data(), nTail);
+            QamKernels::PackBits(tailPoints.data(), tailPacked.data(), nTail);
+            BOOST_CHECK_MESSAGE( std::equal(tailPoints.begin(), tailPoints.end() - 1, expectedPoints.begin() + 8), 
+            names[kernelSet] << " points of " << nTail << " bytes differ" );
+            BOOST_CHECK_MESSAGE( std::equal(tailPacked.begin(), tailPacked.end() - 1, data.begin() + 1), 
+            names[kernelSet] << " bytes of " << nTail << " bytes differ" );
+            BOOST_CHECK_MESSAGE( (tailPoints.back() == 2.0) && (tailPacked.back() == 0xA5), 
+            names[kernelSet] << " written past " << nTail << " bytes" );
+        }
+    }
+    QamKernels::SetKernelSet(defaultSet);
+}
+
+/**
+* Demodulates noisy symbols of every QAM order into likelihood 
+* ratios. The sign of each ratio must agree with the hard decision,
+* every kernel must produce the same ratios and the estimated noise
+* variance must be close to the variance of the added noise.
+* 
+*/
+BOOST_AUTO_TEST_CASE(SoftDemodulation)
+{
+    printf("\nTesting Soft Decision QAM Demodulation...\n");
+
+    size_t nPoints = 1024;
+    size_t pilotToneStep = 8;
+    size_t energyDispersalSeed = 10;
+    double pilotToneAmplitude = 2.0;
+    QamKernelSet defaultSet = QamKernels::GetKernelSet();
+
+    // Setup random float generator
+    srand( (unsigned)time( NULL ) );
+
+    for(size_t bitsPerSymbol : { 2, 4, 6, 8 })
+    {
+        QamModulator qam(nPoints, pilotToneStep, pilotToneAmplitude, energyDispersalSeed, bitsPerSymbol);
+        SubcarrierLayout layout(nPoints, pilotToneStep);
+        size_t nMaxData = qam.GetMaxEncodedBytes();
+        for(size_t nData : { nMaxData, nMaxData - 3 })
+        {
+            ByteVec tx(nData);
+            ByteVec rx(nData);
+            for(size_t i = 0; i < nData; i++)
+            {
+                tx[i] = rand() % 256;
+            }
+            DoubleVec points(nPoints*2, 0.0);
+            qam.Modulate(tx, points, nData);
+
+            // Uniform noise of a tenth of the level spacing
+            double levelScale = sqrt(3.0 / (double) ((1 << bitsPerSymbol) - 1));
+            double noiseAmplitude = levelScale * 0.2;
+            double noiseVariance = 2.0 * noiseAmplitude * noiseAmplitude / 3.0;
+            layout.Update(qam.GetDataPoints(nData));
+            for(size_t index : layout.GetDataIndices())
+            {
+                points[index*2] += noiseAmplitude * (2.0 * rand() / RAND_MAX - 1.0);
+                points[index*2+1] += noiseAmplitude * (2.0 * rand() / RAND_MAX - 1.0);
+            }
+
+            double estimate = qam.EstimateNoiseVariance(points.data(), nData);
+            BOOST_CHECK_MESSAGE( (std::abs(estimate - noiseVariance) < 0.2 * noiseVariance), 
+            "Unexpected noise variance estimate: " << estimate << " expected: " << noiseVariance );
+
+            qam.Demodulate(points, rx, nData);
+            BOOST_REQUIRE( rx == tx );
+
+            std::vector<float> reference;
+            for(QamKernelSet kernelSet : { QAM_KERNEL_SCALAR, QAM_KERNEL_SSE4, QAM_KERNEL_AVX2 })
+            {
+                if(QamKernels::SetKernelSet(kernelSet) != 0)
+                {
+                    continue;
+                }
+                std::vector<float> ratios(nData*8);
+                auto start = std::chrono::steady_clock::now();
+                qam.DemodulateSoft(points.data(), ratios.data(), nData);
+                auto end = std::chrono::steady_clock::now();
+
+                std::cout << (1 << bitsPerSymbol) << "-QAM " << nData << " bytes, kernels: " << kernelSet 
+                << " Soft demodulator elapsed time: "
+                << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+                << " ns" << std::endl;
+
+                for(size_t i = 0; i < nData*8; i++)
+                {
+                    bool bitSet = (tx[i/8] >> (i%8)) & 0x01;
+                    BOOST_CHECK_MESSAGE( ((ratios[i] > 0) == bitSet), 
+                    "Ratio sign differs from the bit! - Occured at index: " << i << " bits per point: " << bitsPerSymbol );
+                }
+                if(reference.empty())
+                {
+                    reference = ratios;
+                    continue;
+                }
+                for(size_t i = 0; i < nData*8; i++)
+                {
+                    BOOST_CHECK_MESSAGE( (std::abs(ratios[i] - reference[i]) <= 1e-5 * std::abs(reference[i])), 
+                    "Kernels differ! - Occured at index: " << i << " bits per point: " << bitsPerSymbol );
+                }
+            }
+        }
+    }
+    QamKernels::SetKernelSet(defaultSet);
+}
+
+/**
+* Passes modulated symbols through a frequency selective channel,
+* a delayed echo with a timing offset, on both layouts. Demodulation
+* without an equaliser must fail, the zero forcing equaliser
+* must recover the data and the channel estimate must
+* follow the channel. The noise variance is estimated over a flat
+* channel.
+* 
+*/
+BOOST_AUTO_TEST_CASE(ChannelEqualisation)
+{
+    printf("\nTesting Channel Estimation and Equalisation...\n");
+
+    size_t nPoints = 1024;
+    size_t pilotToneStep = 8;
+    size_t energyDispersalSeed = 10;
+    double pilotToneAmplitude = 2.0;
+    const double pi = std::acos(-1.0);
+
+    // Setup random float generator
+    srand( (unsigned)time( NULL ) );
+
+    for(size_t bitsPerSymbol : { 4, 6 })
+    {
+        for(bool hermitian : { false, true })
+        {
+            QamModulator qam(nPoints, pilotToneStep, pilotToneAmplitude, energyDispersalSeed, bitsPerSymbol, hermitian);
+            size_t nData = qam.GetMaxEncodedBytes() - 5;
+            ByteVec tx(nData);
+            for(size_t i = 0; i < nData; i++)
+            {
+                tx[i] = rand() % 256;
+            }
+            DoubleVec points(nPoints*2, 0.0);
+            qam.Modulate(tx, points, nData);
+
+            // Channel of frequency f, negative frequencies above nPoints/2
+            auto channel = [&](size_t index)
+            {
+                double frequency = (index < nPoints/2) ? (double) index : (double) index - (double) nPoints;
+                std::complex<double> offset = std::polar(0.9, -2.0 * pi * frequency * 3.0 / nPoints);
+                return offset * (1.0 + std::polar(0.3, -2.0 * pi * frequency * 5.0 / nPoints));
+            };
+            SubcarrierLayout layout(nPoints, pilotToneStep, hermitian);
+            layout.Update(qam.GetDataPoints(nData));
+            std::vector<size_t> used = layout.GetDataIndices();
+            used.insert(used.end(), layout.GetPilotIndices().begin(), layout.GetPilotIndices().end());
+            for(size_t index : used)
+            {
+                std::complex<double> point(points[index*2], points[index*2+1]);
+                point *= channel(index);
+                points[index*2] = point.real() + 0.01 * (2.0 * rand() / RAND_MAX - 1.0);
+                points[index*2+1] = point.imag() + 0.01 * (2.0 * rand() / RAND_MAX - 1.0);
+            }
+
+            for(EqualiserType equaliser : { EQUALISER_NONE, EQUALISER_ZF })
+            {
+                BOOST_REQUIRE( qam.SetEqualiser(equaliser) == 0 );
+                ByteVec rx(nData);
+                auto start = std::chrono::steady_clock::now();
+                qam.Demodulate(points, rx, nData);
+                auto end = std::chrono::steady_clock::now();
+
+                std::cout << (1 << bitsPerSymbol) << "-QAM" << (hermitian ? " Hermitian" : "") << " equaliser: " << equaliser 
+                << " Demodulator elapsed time: "
+                << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+                << " ns" << std::endl;
+
+                if(equaliser == EQUALISER_NONE)
+                {
+                    BOOST_CHECK_MESSAGE( (rx != tx), "Data recovered without an equaliser" );
+                    continue;
+                }
+                for(size_t i = 0; i < nData; i++)
+                {
+                    BOOST_CHECK_MESSAGE( (tx[i] == rx[i]), "Elements differ! - Occured at index: " << i 
+                    << " bits per point: " << bitsPerSymbol << " equaliser: " << equaliser );
+                }
+                const DoubleVec &estimate = qam.GetChannelEstimator().GetChannel();
+                const std::vector<size_t> &dataIndices = layout.GetDataIndices();
+                double maxError = 0.0;
+                for(size_t point = 0; point < dataIndices.size(); point++)
+                {
+                    std::complex<double> error = std::complex<double>(estimate[point*2], estimate[point*2+1]) - channel(dataIndices[point]);
+                    maxError = std::max(maxError, std::abs(error));
+                }
+                BOOST_CHECK_MESSAGE( (maxError < 0.1), "Channel estimate error: " << maxError );
+
+                // Ratios of the equalised points agree with the data
+                std::vector<float> ratios(nData*8);
+                qam.DemodulateSoft(points.data(), ratios.data(), nData);
+                size_t nSignErrors = 0;
+                for(size_t i = 0; i < nData*8; i++)
+                {
+                    nSignErrors += ((ratios[i] > 0) != (bool) ((tx[i/8] >> (i%8)) & 0x01));
+                }
+                BOOST_CHECK_MESSAGE( (nSignErrors == 0), "Ratio signs differ from the data: " << nSignErrors );
+            }
+        }
+    }
+
+    // Pilot tone noise estimate over a flat channel
+    QamModulator qam(nPoints, pilotToneStep, pilotToneAmplitude, energyDispersalSeed, 2);
+    size_t nData = qam.GetMaxEncodedBytes();
+    ByteVec tx(nData, 0x5A);
+    DoubleVec points(nPoints*2, 0.0);
+    qam.Modulate(tx, points, nData);
+    double noiseAmplitude = 0.1;
+    for(size_t i = 0; i < nPoints*2; i++)
+    {
+        points[i] += noiseAmplitude * (2.0 * rand() / RAND_MAX - 1.0);
+    }
+    double noiseVariance = 2.0 * noiseAmplitude * noiseAmplitude / 3.0;
+    qam.SetEqualiser(EQUALISER_ZF);
+    double estimate = qam.EstimateNoiseVariance(points.data(), nData);
+    BOOST_CHECK_MESSAGE( (std::abs(estimate - noiseVariance) < 0.35 * noiseVariance), 
+    "Unexpected noise variance estimate: " << estimate << " expected: " << noiseVariance );
+}
+
+/**
+* Passes 16 and 64-QAM symbols through a channel with a deep fade,
+* |H|^2 down to 0.0009, in Gaussian noise at 30 dB SNR. Points of the 
+* faded carriers must not be biased towards the inner levels, so
+* the zero forcing equaliser decodes the carriers outside the fade
+* without errors.
+* 
+*/
+BOOST_AUTO_TEST_CASE(DeepFadeEqualisation)
+{
+    printf("\nTesting Equalisation of a Deep Fade...\n");
+
+    size_t nPoints = 1024;
+    size_t pilotToneStep = 8;
+    size_t nSymbols = 20;
+    const double pi = std::acos(-1.0);
+    // Average energy of a data point is 2, noise of 30 dB SNR per point
+    double noiseSigma = std::sqrt(2.0 / 1000.0 / 2.0);
+    std::mt19937 generator(7);
+    std::normal_distribution<double> noise(0.0, noiseSigma);
+
+    // Inverted echo of 0.97 delayed by two samples, notches at 0 and half the band
+    auto channel = [&](size_t index)
+    {
+        double frequency = (index < nPoints/2) ? (double) index : (double) index - (double) nPoints;
+        return 1.0 + std::polar(0.97, pi - 2.0 * pi * frequency * 2.0 / nPoints);
+    };
+
+    for(size_t bitsPerSymbol : { 4, 6 })
+    {
+        QamModulator qam(nPoints, pilotToneStep, 2.0, 10, bitsPerSymbol);
+        size_t nData = qam.GetMaxEncodedBytes();
+        SubcarrierLayout layout(nPoints, pilotToneStep, false);
+        layout.Update(qam.GetDataPoints(nData));
+        const std::vector<size_t> &dataIndices = layout.GetDataIndices();
+
+        size_t nErrors = 0;
+        size_t nStrongErrors = 0;
+        for(size_t symbol = 0; symbol < nSymbols; symbol++)
+        {
+            ByteVec tx(nData);
+            for(size_t i = 0; i < nData; i++)
+            {
+                tx[i] = generator() % 256;
+            }
+            DoubleVec points(nPoints*2, 0.0);
+            qam.Modulate(tx, points, nData);
+            for(size_t index = 0; index < nPoints; index++)
+            {
+                std::complex<double> point = std::complex<double>(points[index*2], points[index*2+1]) * channel(index);
+                points[index*2] = point.real() + noise(generator);
+                points[index*2+1] = point.imag() + noise(generator);
+            }
+
+            ByteVec rx(nData);
+            BOOST_REQUIRE( qam.SetEqualiser(EQUALISER_ZF) == 0 );
+            qam.Demodulate(points, rx, nData);
+            for(size_t i = 0; i < nData; i++)
+            {
+                nErrors += std::bitset<8>(tx[i] ^ rx[i]).count();
+            }
+
+            // Bits of the points of carriers outside the fade, 
+            // the last point may share its byte with the next point
+            for(size_t point = 0; (point + 1)*bitsPerSymbol <= nData*8; point++)
+            {
+                if(std::norm(channel(dataIndices[point])) < 0.5)
+                {
+                    continue;
+                }
+                for(size_t bit = point*bitsPerSymbol; bit < (point + 1)*bitsPerSymbol; bit++)
+                {
+                    nStrongErrors += ((tx[bit/8] ^ rx[bit/8]) >> (bit%8)) & 0x01;
+                }
+            }
+        }
+        std::cout << (1 << bitsPerSymbol) << "-QAM bit errors zero forcing: " << nErrors 
+        << " outside the fade: " << nStrongErrors << std::endl;
+        BOOST_CHECK_MESSAGE( (nStrongErrors == 0), "Errors outside the fade: " << nStrongErrors );
+    }
+}
+
+/**
+* Feeds the demodulator with points scaled by nPoints, as an
+* unnormalised FFT output, and folds the normalisation into the
+* demodulator. Hard decisions, likelihood ratios and the channel
+* estimate must match those of the normalised points.
+* 
+*/
+BOOST_AUTO_TEST_CASE(InputScaleFolding)
+{
+    printf("\nTesting Input Scale Folding...\n");
+
+    size_t nPoints = 1024;
+    size_t pilotToneStep = 8;
+    size_t energyDispersalSeed = 10;
+    double pilotToneAmplitude = 2.0;
+
+    // Setup random float generator
+    srand( (unsigned)time( NULL ) );
+
+    for(EqualiserType equaliser : { EQUALISER_NONE, EQUALISER_ZF })
+    {
+        QamModulator qam(nPoints, pilotToneStep, pilotToneAmplitude, energyDispersalSeed, 6);
+        QamModulator scaledQam(nPoints, pilotToneStep, pilotToneAmplitude, energyDispersalSeed, 6);
+        qam.SetEqualiser(equaliser);
+        scaledQam.SetEqualiser(equaliser);
+        BOOST_REQUIRE( scaledQam.SetInputScale(1.0 / nPoints) == 0 );
+        BOOST_CHECK( scaledQam.SetInputScale(0.0) == -1 );
+
+        size_t nData = qam.GetMaxEncodedBytes();
+        ByteVec tx(nData);
+        for(size_t i = 0; i < nData; i++)
+        {
+            tx[i] = rand() % 256;
+        }
+        DoubleVec points(nPoints*2, 0.0);
+        qam.Modulate(tx, points, nData);
+        DoubleVec scaledPoints(nPoints*2);
+        for(size_t i = 0; i < nPoints*2; i++)
+        {
+            points[i] += 0.02 * (2.0 * rand() / RAND_MAX - 1.0);
+            scaledPoints[i] = points[i] * nPoints;
+        }
+
+        ByteVec rx(nData);
+        ByteVec scaledRx(nData);
+        qam.Demodulate(points, rx, nData);
+        scaledQam.Demodulate(scaledPoints, scaledRx, nData);
+        BOOST_CHECK( rx == tx );
+        BOOST_CHECK( scaledRx == tx );
+
+        std::vector<float> ratios(nData*8);
+        std::vector<float> scaledRatios(nData*8);
+        qam.DemodulateSoft(points.data(), ratios.data(), nData);
+        scaledQam.DemodulateSoft(scaledPoints.data(), scaledRatios.data(), nData);
+        for(size_t i = 0; i < nData*8; i++)
+        {
+            BOOST_CHECK_MESSAGE( (std::abs(ratios[i] - scaledRatios[i]) <= 1e-4 * std::abs(ratios[i]) + 1e-3), 
+            "Ratios differ! - Occured at index: " << i << " equaliser: " << equaliser );
+        }
+
+        const DoubleVec &channel = qam.GetChannelEstimator().GetChannel();
+        const DoubleVec &scaledChannel = scaledQam.GetChannelEstimator().GetChannel();
+        for(size_t i = 0; i < channel.size(); i++)
+        {
+            BOOST_CHECK_MESSAGE( (std::abs(channel[i] - scaledChannel[i]) < 1e-9), "Channel estimates differ! - Occured at index: " << i );
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()